@@ -9,23 +9,51 @@ BUILD_TYPE=${1:-release}
 
 if [ "$BUILD_TYPE" = "debug" ]; then
     echo "Building in DEBUG mode..."
-    g++ -std=c++20 -fconcepts -fcoroutines -g -Wall -Wextra \
+    g++ -std=c++20 -fconcepts -fcoroutines -pthread -g -DTRADE_SIM_ALLOC_AUDIT -Wall -Wextra \
         main.cpp \
         src/data_loader.cpp \
         src/backtester.cpp \
+        src/bar_source.cpp \
+        src/fixed_point.cpp \
+        src/run_arena.cpp \
+        src/alloc_audit.cpp \
+        src/indicators/indicator_cache.cpp \
         src/strategies/sma_strategy.cpp \
         src/strategies/ema_strategy.cpp \
         src/strategies/mean_reversion_strategy.cpp \
+        src/sweep/shared_dataset.cpp \
+        src/sweep/sweep_job.cpp \
+        src/sweep/sweep_coordinator.cpp \
+        src/sweep/adaptive_optimizer.cpp \
+        src/sweep/results_store.cpp \
+        src/risk/risk_engine.cpp \
+        src/events/event_scheduler.cpp \
+        src/factors/panel_data.cpp \
+        src/factors/cross_section.cpp \
         -o main
 else
     echo "Building in RELEASE mode..."
-    g++ -std=c++20 -fconcepts -fcoroutines -O2 -Wall -Wextra \
+    g++ -std=c++20 -fconcepts -fcoroutines -pthread -O2 -Wall -Wextra \
         main.cpp \
         src/data_loader.cpp \
         src/backtester.cpp \
+        src/bar_source.cpp \
+        src/fixed_point.cpp \
+        src/run_arena.cpp \
+        src/alloc_audit.cpp \
+        src/indicators/indicator_cache.cpp \
         src/strategies/sma_strategy.cpp \
         src/strategies/ema_strategy.cpp \
         src/strategies/mean_reversion_strategy.cpp \
+        src/sweep/shared_dataset.cpp \
+        src/sweep/sweep_job.cpp \
+        src/sweep/sweep_coordinator.cpp \
+        src/sweep/adaptive_optimizer.cpp \
+        src/sweep/results_store.cpp \
+        src/risk/risk_engine.cpp \
+        src/events/event_scheduler.cpp \
+        src/factors/panel_data.cpp \
+        src/factors/cross_section.cpp \
         -o main
 fi
 
@@ -5,10 +5,803 @@
 #include "src/strategies/sma_strategy.h"
 #include "src/strategies/ema_strategy.h"
 #include "src/strategies/mean_reversion_strategy.h"
+#include "src/sweep/sweep_coordinator.h"
+#include "src/sweep/adaptive_optimizer.h"
+#include "src/sweep/results_store.h"
+#include "src/events/event_scheduler.h"
+#include "src/factors/cross_section.h"
+#include "src/risk/risk_engine.h"
+#include "src/signals/signal_dsl.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <chrono>
+#include <string>
+#include <random>
+#include <cmath>
 
-int main() {
+// Top runs and per-strategy aggregates from a sweep's results store
+static void print_store_summary(const ResultsStore& store) {
+    auto best = store.top_k(ResultColumn::TotalReturn, 10);
+    std::cout << std::format("\n=== Top {} by Total Return ===\n", best.size());
+    std::cout << std::format("{:<20} {:<12} {:<12} {:<12}\n", "Parameters", "Total Return", "Max Drawdown", "Trades");
+    for (uint32_t row : best) {
+        std::cout << std::format("{:<20} {:<12.2f} {:<12.2f} {:<12}\n", describe(store.params(row)), 
+            store.value(ResultColumn::TotalReturn, row), store.value(ResultColumn::MaxDrawdown, row), 
+            store.value(ResultColumn::TotalTrades, row));
+    }
+    
+    // Return per strategy family, over the runs that traded at all
+    const char* kind_names[] = {"SMA Crossover", "EMA Crossover", "Mean Reversion"};
+    auto groups = store.aggregate(ResultColumn::Kind, ResultColumn::TotalReturn, 
+        {{ResultColumn::TotalTrades, Compare::Greater, 0}});
+    std::cout << std::format("\n=== Total Return by Strategy ===\n");
+    std::cout << std::format("{:<20} {:<8} {:<12} {:<12} {:<12}\n", "Strategy", "Runs", "Mean", "Worst", "Best");
+    for (const auto& group : groups) {
+        std::cout << std::format("{:<20} {:<8} {:<12.2f} {:<12.2f} {:<12.2f}\n", 
+            kind_names[static_cast<size_t>(group.key)], group.count, group.mean(), group.min, group.max);
+    }
+}
+
+// Reload a saved sweep and summarize it without rerunning anything
+static int run_query(const std::string& store_path) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    ResultsStore store = ResultsStore::load(store_path);
+    print_store_summary(store);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start_time);
+    
+    std::cout << std::format("\nQueried {} results from {} in {} microseconds\n", store.size(), store_path, elapsed.count());
+    return 0;
+}
+
+// Random walk rounded to whole cents, for checks that need far more bars than
+// the bundled CSVs hold. Rounding makes equal closes and exact band touches common.
+static std::vector<MarketData> random_walk_bars(size_t count, uint64_t seed = 7) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> shock(0.0, 0.01);
+    std::vector<MarketData> bars;
+    bars.reserve(count);
+    double log_price = std::log(100.0);
+    for (size_t i = 0; i < count; ++i) {
+        log_price += shock(rng);
+        double close = std::max(std::round(std::exp(log_price) * 100.0) / 100.0, 0.01);
+        bars.push_back(MarketData{std::format("{:07}", i), close, close, close, close, 1000});
+    }
+    return bars;
+}
+
+// SMA/EMA crossover and mean-reversion grid used by the sweep modes
+static std::vector<SweepParams> sweep_grid() {
+    std::vector<SweepParams> grid = ParameterGrid::crossover(StrategyKind::SMACrossover, 
+        ParameterGrid::range(2, 30), ParameterGrid::range(10, 120, 2));
+    auto ema_grid = ParameterGrid::crossover(StrategyKind::EMACrossover, 
+        ParameterGrid::range(2, 30), ParameterGrid::range(10, 120, 2));
+    auto mr_grid = ParameterGrid::mean_reversion(ParameterGrid::range(5, 60), {1.0, 1.5, 2.0, 2.5, 3.0});
+    grid.insert(grid.end(), ema_grid.begin(), ema_grid.end());
+    grid.insert(grid.end(), mr_grid.begin(), mr_grid.end());
+    return grid;
+}
+
+// Parameter sweep sharded across worker processes
+static int run_sweep(const std::string& filename, size_t num_workers, const std::string& store_path) {
+    auto load = DataLoader::loadCSV_safe(filename);
+    if (!load.is_success()) {
+        std::cout << std::format("Error: {}\n", load.get_error());
+        return 1;
+    }
+    
+    std::vector<SweepParams> grid = sweep_grid();
+    
+    SweepConfig config;
+    config.num_workers = num_workers;
+    ForkLauncher launcher;
+    SweepCoordinator coordinator(load.data, config, launcher);
+    
+    std::cout << std::format("Sweeping {} parameter sets across {} worker processes...\n", grid.size(), num_workers);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto results = coordinator.run(grid);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start_time);
+    
+    ResultsStore store;
+    store.append(grid, results);
+    store.save(store_path);
+    print_store_summary(store);
+    
+    std::cout << std::format("\nSaved {} results to {}\n", store.size(), store_path);
+    std::cout << std::format("\nCompleted in {} ms ({} worker failures recovered)\n", 
+        elapsed.count(), coordinator.get_failure_count());
+    
+    return 0;
+}
+
+// Metrics two runs of the same job must agree on exactly
+static bool same_result(const SweepResult& a, const SweepResult& b) {
+    return a.job_id == b.job_id && a.total_trades == b.total_trades && a.total_return == b.total_return &&
+           a.sharpe_ratio == b.sharpe_ratio && a.max_drawdown == b.max_drawdown && a.win_rate == b.win_rate &&
+           a.avg_trade_pnl == b.avg_trade_pnl && a.bars_processed == b.bars_processed;
+}
+
+// Sweep with workers that crash or hang partway through, checked against a clean sweep;
+// then the indicator cache, checked against recomputing every indicator per job
+static int run_sweep_check(const std::string& filename, size_t num_workers) {
+    auto load = DataLoader::loadCSV_safe(filename);
+    if (!load.is_success()) {
+        std::cout << std::format("Error: {}\n", load.get_error());
+        return 1;
+    }
+    
+    std::vector<SweepParams> grid = sweep_grid();
+    SweepConfig config;
+    config.num_workers = num_workers;
+    config.job_timeout_ms = 1000;
+    config.max_restarts = num_workers + 2;
+    
+    ForkLauncher launcher;
+    SweepCoordinator clean(load.data, config, launcher);
+    auto expected = clean.run(grid);
+    
+    // Two workers crash and one hangs, each after 20 jobs
+    FaultInjectingLauncher faulty_launcher(launcher, 2, 1, 20);
+    SweepCoordinator faulty(load.data, config, faulty_launcher);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto results = faulty.run(grid);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start_time);
+    
+    size_t mismatches = 0;
+    for (size_t i = 0; i < grid.size(); ++i) {
+        if (!same_result(expected[i], results[i])) mismatches++;
+    }
+    
+    std::cout << std::format("Faulty sweep: {} jobs in {} ms, {} worker failures recovered ({} hung)\n", 
+        grid.size(), elapsed.count(), faulty.get_failure_count(), faulty.get_timeout_count());
+    std::cout << std::format("Results identical to a clean sweep: {} ({} mismatches)\n", 
+        mismatches == 0 ? "yes" : "NO", mismatches);
+    
+    // The clean sweep above used the indicator cache; the same grid without it
+    SweepConfig uncached_config = config;
+    uncached_config.indicator_cache_bytes = 0;
+    SweepCoordinator uncached(load.data, uncached_config, launcher);
+    auto uncached_results = uncached.run(grid);
+    size_t cache_mismatches = 0;
+    for (size_t i = 0; i < grid.size(); ++i) {
+        if (!same_result(expected[i], uncached_results[i])) cache_mismatches++;
+    }
+    
+    // And on a long cent-rounded walk, where equal closes and exact band touches are common
+    constexpr size_t WALK_BARS = 100000;
+    std::vector<MarketData> walk = random_walk_bars(WALK_BARS);
+    std::vector<SweepParams> walk_grid = ParameterGrid::crossover(StrategyKind::SMACrossover, {2, 5, 10, 20}, {20, 50, 100});
+    auto walk_ema = ParameterGrid::crossover(StrategyKind::EMACrossover, {2, 5, 10, 20}, {20, 50, 100});
+    auto walk_mr = ParameterGrid::mean_reversion({2, 5, 20, 60}, {1.0, 2.0});
+    walk_grid.insert(walk_grid.end(), walk_ema.begin(), walk_ema.end());
+    walk_grid.insert(walk_grid.end(), walk_mr.begin(), walk_mr.end());
+    
+    Backtester walk_backtester(std::make_unique<VectorBarSource>(walk), config.initial_cash);
+    IndicatorCache cache(config.indicator_cache_bytes);
+    PriceSeries series = PriceSeries::from_market_data(walk);
+    for (size_t i = 0; i < walk_grid.size(); ++i) {
+        uint32_t job_id = static_cast<uint32_t>(i);
+        SweepResult direct = run_sweep_job(walk_backtester, job_id, walk_grid[i]);
+        SweepResult cached = run_sweep_job(walk_backtester, job_id, walk_grid[i], cache, series);
+        if (!same_result(direct, cached)) {
+            cache_mismatches++;
+            std::cout << std::format("MISMATCH {} on the walk: {:.4f}% / {} trades cached, {:.4f}% / {} uncached\n", 
+                describe(walk_grid[i]), cached.total_return, cached.total_trades, direct.total_return, direct.total_trades);
+        }
+    }
+    std::cout << std::format("Cached indicators identical to uncached: {} ({} sweep jobs, {} jobs on a {}-bar walk, {} mismatches)\n", 
+        cache_mismatches == 0 ? "yes" : "NO", grid.size(), walk_grid.size(), WALK_BARS, cache_mismatches);
+    
+    return mismatches == 0 && cache_mismatches == 0 && faulty.get_failure_count() == 3 ? 0 : 1;
+}
+
+// Successive halving and evolutionary search compared against the exhaustive grid
+static int run_optimize(const std::string& filename) {
+    auto load = DataLoader::loadCSV_safe(filename);
+    if (!load.is_success()) {
+        std::cout << std::format("Error: {}\n", load.get_error());
+        return 1;
+    }
+    
+    std::vector<SweepParams> grid = ParameterGrid::crossover(StrategyKind::SMACrossover, 
+        ParameterGrid::range(2, 30), ParameterGrid::range(10, 120, 2));
+    auto ema_grid = ParameterGrid::crossover(StrategyKind::EMACrossover, 
+        ParameterGrid::range(2, 30), ParameterGrid::range(10, 120, 2));
+    grid.insert(grid.end(), ema_grid.begin(), ema_grid.end());
+    
+    OptimizerConfig config;
+    config.early_stop.max_drawdown = 3.0;
+    config.early_stop.min_return = -2.0;
+    AdaptiveOptimizer optimizer(load.data, config);
+    
+    auto baseline = optimizer.exhaustive(grid);
+    auto halving = optimizer.successive_halving(grid);
+    
+    SearchSpace space{StrategyKind::EMACrossover, 2, 30, 10, 120};
+    auto evolved = optimizer.evolutionary(space);
+    
+    auto overlap = [&](const OptimizerReport& report) {
+        size_t hits = 0;
+        for (const auto& a : report.top) {
+            for (const auto& b : baseline.top) {
+                if (a.params.kind == b.params.kind && a.params.short_window == b.params.short_window &&
+                    a.params.long_window == b.params.long_window) {
+                    hits++;
+                    break;
+                }
+            }
+        }
+        return hits;
+    };
+    
+    std::cout << std::format("\n=== Optimizer Comparison ({} candidates, top {}) ===\n", grid.size(), config.top_k);
+    std::cout << std::format("{:<20} {:<12} {:<12} {:<14} {:<12}\n", "Mode", "Evaluated", "Pruned", "Bar Evals", "Top-K Hits");
+    auto row = [&](const std::string& name, const OptimizerReport& report) {
+        std::cout << std::format("{:<20} {:<12} {:<12} {:<14} {:<12}\n", name, report.candidates_evaluated, 
+            report.candidates_pruned, report.bar_evaluations, overlap(report));
+    };
+    row("Exhaustive", baseline);
+    row("Successive Halving", halving);
+    row("Evolutionary (EMA)", evolved);
+    
+    std::cout << std::format("\nBest found by successive halving:\n");
+    for (const auto& candidate : halving.top) {
+        std::cout << std::format("{:<20} {:.2f}%\n", describe(candidate.params), candidate.total_return);
+    }
+    
+    auto cache = optimizer.cache_stats();
+    std::cout << std::format("\nIndicator cache: {} hits, {} misses, {} columns ({} KB)\n", 
+        cache.hits, cache.misses, cache.entries, cache.bytes / 1024);
+    
+    return 0;
+}
+
+// Average wall time of `reps` fresh runs of a strategy
+template<TradingStrategy T>
+static double time_strategy(Backtester& backtester, const T& prototype, int reps, BacktestResult& result) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        T strategy = prototype;
+        result = backtester.run_backtest(strategy);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start_time);
+    return elapsed.count() / 1000.0 / reps;
+}
+
+// Counts events per feed as they arrive from the scheduler
+static EventTask count_events(EventScheduler& scheduler, std::vector<size_t>& counts) {
+    while (const Event* event = co_await scheduler.next_event()) {
+        counts[event->feed]++;
+    }
+}
+
+static EventTask record_timestamps(EventScheduler& scheduler, std::vector<int64_t>& timestamps) {
+    while (const Event* event = co_await scheduler.next_event()) {
+        timestamps.push_back(event->timestamp);
+    }
+}
+
+// Brute-force check of the cross-sectional engine on a small panel: every factor value,
+// score and basket recomputed directly, and the equity curve replayed from the baskets.
+// Tiles of 100 bars put the Reversal resyncs (every 1024 bars) mid-tile, lookbacks span
+// tiles, and the synthetic universe lists and delists symbols mid-panel.
+static size_t check_cross_section(const PanelData& panel, const std::string& name, std::vector<FactorSpec> factors) {
+    const size_t n = panel.num_symbols();
+    CrossSectionConfig config;
+    config.factors = std::move(factors);
+    config.rebalance_interval = 3;
+    config.tile_bars = 100;
+    config.threads = 4;
+    
+    // Two-pass window statistics; any missing close in the window leaves the value missing
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    auto factor_value = [&](const FactorSpec& factor, size_t bar, size_t s) {
+        if (factor.kind == FactorKind::Momentum) {
+            if (bar < factor.lookback) return missing;
+            return panel.close(bar - factor.skip, s) / panel.close(bar - factor.lookback, s) - 1.0;
+        }
+        if (bar + 1 < factor.lookback) return missing;
+        double mean = 0.0;
+        for (size_t b = bar + 1 - factor.lookback; b <= bar; ++b) {
+            if (std::isnan(panel.close(b, s))) return missing;
+            mean += panel.close(b, s);
+        }
+        mean /= factor.lookback;
+        double variance = 0.0;
+        for (size_t b = bar + 1 - factor.lookback; b <= bar; ++b) {
+            variance += (panel.close(b, s) - mean) * (panel.close(b, s) - mean);
+        }
+        variance /= factor.lookback;
+        return variance > 0.0 ? -(panel.close(bar, s) - mean) / std::sqrt(variance) : missing;
+    };
+    
+    CrossSectionalEngine engine(panel, config);
+    std::vector<std::vector<TargetWeight>> baskets(panel.num_bars());
+    size_t factor_mismatches = 0, basket_mismatches = 0;
+    double max_error = 0.0;
+    engine.set_tile_hook([&](size_t first_bar, size_t bars) {
+        for (size_t t = 0; t < bars; ++t) {
+            size_t bar = first_bar + t;
+            std::vector<double> scores(n, 0.0);
+            for (size_t f = 0; f < config.factors.size(); ++f) {
+                std::vector<double> values(n);
+                for (size_t s = 0; s < n; ++s) {
+                    values[s] = factor_value(config.factors[f], bar, s);
+                    double engine_value = engine.factor_value(f, t, s);
+                    if (std::isnan(values[s]) || std::isnan(engine_value)) {
+                        if (std::isnan(values[s]) != std::isnan(engine_value)) factor_mismatches++;
+                        continue;
+                    }
+                    double error = std::abs(engine_value - values[s]) / std::max(1.0, std::abs(values[s]));
+                    max_error = std::max(max_error, error);
+                    if (error > 1e-6) factor_mismatches++;    // The engine slides single-pass sums
+                }
+                
+                // One factor scores as is; several are standardized over the symbols with a value
+                double mean = 0.0, variance = 0.0;
+                size_t count = 0;
+                for (double value : values) {
+                    if (!std::isnan(value)) { mean += value; count++; }
+                }
+                mean = count > 0 ? mean / count : 0.0;
+                for (double value : values) {
+                    if (!std::isnan(value)) variance += (value - mean) * (value - mean);
+                }
+                variance = count > 0 ? variance / count : 0.0;
+                double weight = config.factors[f].weight;
+                double scale = variance > 0.0 ? weight / std::sqrt(variance) : 0.0;
+                for (size_t s = 0; s < n; ++s) {
+                    scores[s] = config.factors.size() == 1 ? weight * values[s] : scores[s] + (values[s] - mean) * scale;
+                }
+            }
+            if (bar % config.rebalance_interval != 0) continue;
+            
+            // Full sort: best score first, ties by symbol
+            std::vector<std::pair<double, uint32_t>> ranks;
+            for (size_t s = 0; s < n; ++s) {
+                if (std::isfinite(scores[s])) ranks.push_back({-scores[s], static_cast<uint32_t>(s)});
+            }
+            std::sort(ranks.begin(), ranks.end());
+            size_t long_count = static_cast<size_t>(ranks.size() * config.long_fraction);
+            size_t short_count = static_cast<size_t>(ranks.size() * config.short_fraction);
+            std::vector<std::pair<uint32_t, double>> expected, actual;
+            for (size_t i = 0; i < long_count; ++i) {
+                expected.push_back({ranks[i].second, config.gross_long / long_count});
+            }
+            for (size_t i = ranks.size() - short_count; i < ranks.size(); ++i) {
+                expected.push_back({ranks[i].second, -config.gross_short / short_count});
+            }
+            for (const auto& target : engine.targets(t)) actual.push_back({target.symbol, target.weight});
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            if (expected != actual) basket_mismatches++;
+            baskets[bar].assign(engine.targets(t).begin(), engine.targets(t).end());
+        }
+    });
+    auto result = engine.run();
+    
+    // Replay the checked baskets (in the engine's order, so sizing rounds the same) bar by bar
+    Rebalancer rebalancer(n, config.initial_cash, config.cost_bps);
+    size_t equity_mismatches = 0;
+    for (size_t bar = 0; bar < panel.num_bars(); ++bar) {
+        rebalancer.mark(panel.row(bar));
+        if (!baskets[bar].empty()) rebalancer.rebalance(baskets[bar]);
+        if (rebalancer.get_equity() != result.equity_curve[bar]) equity_mismatches++;
+    }
+    
+    size_t mismatches = factor_mismatches + basket_mismatches + equity_mismatches;
+    std::cout << std::format("{:<22} factor error {:.1e}, mismatched factors {}, baskets {}, equity bars {} - {}\n", 
+        name, max_error, factor_mismatches, basket_mismatches, equity_mismatches, mismatches == 0 ? "ok" : "MISMATCH");
+    return mismatches;
+}
+
+// Decile long/short factor portfolios over a synthetic symbol universe
+static int run_cross_section(size_t num_symbols, size_t num_bars) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    PanelData panel = PanelData::synthetic(num_symbols, num_bars);
+    auto panel_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start_time).count();
+    std::cout << std::format("Panel: {} symbols x {} bars ({} to {}), {} MB, generated in {} ms\n", 
+        panel.num_symbols(), panel.num_bars(), panel.date(0), panel.date(panel.num_bars() - 1),
+        panel.price_bytes() / (1024 * 1024), panel_ms);
+    
+    std::cout << std::format("\n=== Cross-Sectional Factor Portfolios (top/bottom decile, daily) ===\n");
+    std::cout << std::format("{:<22} {:<10} {:<10} {:<10} {:<10} {:<10} {:<10} {:<10}\n", 
+        "Factor", "Return %", "Sharpe", "Max DD %", "Turnover", "Positions", "Orders", "Time (ms)");
+    auto report = [&](const std::string& name, std::vector<FactorSpec> factors) {
+        CrossSectionConfig config;
+        config.factors = std::move(factors);
+        CrossSectionalEngine engine(panel, config);
+        auto result = engine.run();
+        std::cout << std::format("{:<22} {:<10.2f} {:<10.2f} {:<10.2f} {:<10.3f} {:<10.0f} {:<10} {:<10}\n", 
+            name, result.total_return, result.sharpe_ratio, result.max_drawdown, result.avg_turnover, 
+            result.avg_positions, result.orders, result.total_micros / 1000);
+        return result;
+    };
+    report("Momentum 12-1", {{FactorKind::Momentum, 252, 21}});
+    report("Reversal z(5)", {{FactorKind::Reversal, 5}});
+    auto blend = report("Momentum + Reversal", {{FactorKind::Momentum, 252, 21}, {FactorKind::Reversal, 5}});
+    
+    std::cout << std::format("\nStage times for the blend: factors {} ms, ranking {} ms, rebalancing {} ms\n", 
+        blend.factor_micros / 1000, blend.rank_micros / 1000, blend.rebalance_micros / 1000);
+    
+    PanelData small = PanelData::synthetic(600, 2300, 7);
+    std::cout << std::format("\n=== Brute-force check ({} symbols x {} bars, 100-bar tiles) ===\n", 
+        small.num_symbols(), small.num_bars());
+    size_t mismatches = check_cross_section(small, "Momentum 12-1", {{FactorKind::Momentum, 252, 21}});
+    mismatches += check_cross_section(small, "Reversal z(5)", {{FactorKind::Reversal, 5}});
+    mismatches += check_cross_section(small, "Momentum + Reversal", 
+        {{FactorKind::Momentum, 252, 21}, {FactorKind::Reversal, 130, 0, 0.5}});
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Rolling risk of an equal-weight book: per-bar cost and a brute-force check of the estimates
+static int run_risk(size_t num_assets, size_t num_bars, size_t window) {
+    // Synthetic universe; symbols listed late or delisted early have NaN closes there
+    PanelData panel = PanelData::synthetic(num_assets, num_bars);
+    const size_t n = panel.num_symbols();
+    
+    std::vector<std::vector<double>> prices(num_bars, std::vector<double>(n));
+    for (size_t bar = 0; bar < num_bars; ++bar) {
+        for (size_t i = 0; i < n; ++i) prices[bar][i] = panel.close(bar, i);
+    }
+    std::vector<double> weights(n, 1.0 / n);
+    
+    RiskEngine risk(n, window, 0.99);
+    using Clock = std::chrono::high_resolution_clock;
+    long long update_ns = 0, evaluate_ns = 0;
+    std::vector<long long> update_times;
+    update_times.reserve(num_bars);
+    for (size_t bar = 0; bar < num_bars; ++bar) {
+        auto start = Clock::now();
+        risk.update(prices[bar]);
+        auto updated = Clock::now();
+        risk.evaluate(weights);
+        auto evaluated = Clock::now();
+        
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(updated - start).count();
+        update_ns += ns;
+        update_times.push_back(ns);
+        evaluate_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(evaluated - updated).count();
+    }
+    const RiskReport& report = risk.evaluate(weights);
+    std::sort(update_times.begin(), update_times.end());
+    
+    // Brute force over the final window: two-pass covariance, portfolio losses sorted.
+    // A missing close holds the last one and contributes a zero return, as in update().
+    size_t m = std::min(window, num_bars - 1);
+    std::vector<std::vector<double>> returns(m, std::vector<double>(n));
+    std::vector<double> last = prices[0];
+    for (size_t bar = 1; bar < num_bars; ++bar) {
+        for (size_t i = 0; i < n; ++i) {
+            double price = prices[bar][i];
+            double r = 0.0;
+            if (!std::isnan(price)) {
+                if (last[i] > 0) r = (price - last[i]) / last[i];
+                last[i] = price;
+            }
+            if (bar >= num_bars - m) returns[bar - (num_bars - m)][i] = r;
+        }
+    }
+    std::vector<double> means(n, 0.0);
+    for (const auto& r : returns) {
+        for (size_t i = 0; i < n; ++i) means[i] += r[i] / m;
+    }
+    double max_error = 0.0, max_cov = 0.0, variance = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) {
+            double cov = 0.0;
+            for (const auto& r : returns) cov += (r[i] - means[i]) * (r[j] - means[j]);
+            cov /= (m - 1.0);
+            max_cov = std::max(max_cov, std::abs(cov));
+            max_error = std::max(max_error, std::abs(cov - risk.covariance(i, j)));
+            variance += (i == j ? 1.0 : 2.0) * weights[i] * weights[j] * cov;
+        }
+    }
+    std::vector<double> losses;
+    for (const auto& r : returns) {
+        double loss = 0.0;
+        for (size_t i = 0; i < n; ++i) loss -= r[i] * weights[i];
+        losses.push_back(loss);
+    }
+    std::sort(losses.begin(), losses.end());
+    size_t var_index = std::min(static_cast<size_t>(std::ceil(0.99 * m)) - 1, m - 1);
+    
+    std::cout << std::format("=== Rolling Risk ({} assets, {}-bar window, {} bars) ===\n", n, window, num_bars);
+    std::cout << std::format("Update:   {:.1f} us/bar (p99 {:.1f} us, max {:.1f} us)\n", update_ns / 1000.0 / num_bars,
+        update_times[update_times.size() * 99 / 100] / 1000.0, update_times.back() / 1000.0);
+    std::cout << std::format("Evaluate: {:.1f} us/bar\n", evaluate_ns / 1000.0 / num_bars);
+    std::cout << std::format("Volatility {:.6f}% (brute force {:.6f}%), 99% VaR {:.4f}% (brute force {:.4f}%), CVaR {:.4f}%\n", 
+        report.volatility * 100.0, std::sqrt(variance) * 100.0, report.historical_var * 100.0, 
+        losses[var_index] * 100.0, report.historical_cvar * 100.0);
+    
+    double relative_error = max_cov > 0 ? max_error / max_cov : 0.0;
+    double var_error = std::abs(report.historical_var - losses[var_index]);
+    bool ok = relative_error < 1e-9 && var_error <= 1e-12 * std::abs(losses[var_index]);
+    std::cout << std::format("Max covariance error vs brute force: {:.3e} (relative {:.3e}) - {}\n", 
+        max_error, relative_error, ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+// Merges several irregular feeds with the coroutine scheduler and runs a strategy on one of them
+static int run_events(const std::string& filename, const std::string& second_filename, size_t extra_feeds) {
+    auto load = DataLoader::loadCSV_safe(filename);
+    auto second = DataLoader::loadCSV_safe(second_filename);
+    if (!load.is_success() || !second.is_success()) {
+        std::cout << std::format("Error: {}\n", load.is_success() ? second.get_error() : load.get_error());
+        return 1;
+    }
+    std::reverse(second.data.begin(), second.data.end());  // Stored newest first
+    
+    // Signal source: closes above the highest close of the previous 20 bars
+    auto breakout = [highs = RollingWindow<double>(20)](const MarketData& bar) mutable {
+        double highest = 0.0;
+        highs.for_each([&](double close) { highest = std::max(highest, close); });
+        bool fires = highs.full() && bar.close > highest;
+        highs.push(bar.close);
+        return fires;
+    };
+    
+    EventScheduler scheduler;
+    uint32_t qqqm = scheduler.add_feed("QQQM", feeds::replay(load.data));
+    scheduler.add_feed("QQQM 5-bar", feeds::resample(feeds::replay(load.data), 5));
+    scheduler.add_feed("QQQM breakouts", feeds::filter(feeds::replay(load.data), breakout));
+    scheduler.add_feed("SPY", feeds::replay(second.data));
+    for (size_t i = 0; i < extra_feeds; ++i) {
+        scheduler.add_feed(std::format("QQQM replay {}", i), feeds::replay(load.data));
+    }
+    
+    std::vector<size_t> counts(scheduler.feed_count());
+    SMACrossoverStrategy sma;
+    Portfolio portfolio(100000.0);
+    scheduler.spawn(count_events(scheduler, counts));
+    scheduler.spawn(drive(scheduler, qqqm, sma, portfolio));
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    size_t events = scheduler.run();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start_time);
+    
+    std::cout << std::format("=== Merged {} events from {} feeds in {} microseconds ===\n", 
+        events, scheduler.feed_count(), elapsed.count());
+    for (uint32_t feed = 0; feed < std::min<size_t>(scheduler.feed_count(), 5); ++feed) {
+        std::cout << std::format("{:<20} {} events\n", scheduler.feed_name(feed), counts[feed]);
+    }
+    
+    // Same strategy through the plain backtest loop
+    Backtester backtester(filename, 100000.0);
+    SMACrossoverStrategy reference;
+    auto result = backtester.run_backtest(reference);
+    std::cout << std::format("\nSMA on the QQQM feed: {} trades, {:.2f}% return (backtester: {} trades, {:.2f}%)\n", 
+        portfolio.trades.size(), portfolio.get_total_return(), result.all_trades.size(), result.total_return);
+    
+    // Intraday feeds: half-hourly and hourly bars over two sessions interleave by time of day
+    std::vector<MarketData> half_hourly, hourly;
+    for (const char* day : {"08/04/2025", "08/05/2025"}) {
+        for (int minutes = 9 * 60 + 30; minutes <= 16 * 60; minutes += 30) {
+            MarketData bar{std::format("{} {:02}:{:02}", day, minutes / 60, minutes % 60), 100.0, 100.0, 100.0, 100.0, 100};
+            if (minutes % 60 == 0) hourly.push_back(bar);
+            half_hourly.push_back(std::move(bar));
+        }
+    }
+    EventScheduler intraday;
+    intraday.add_feed("hourly", feeds::replay(hourly));
+    intraday.add_feed("half-hourly", feeds::replay(half_hourly));
+    std::vector<int64_t> timestamps;
+    intraday.spawn(record_timestamps(intraday, timestamps));
+    intraday.run();
+    bool ordered = timestamps.size() == hourly.size() + half_hourly.size() && 
+                   std::is_sorted(timestamps.begin(), timestamps.end());
+    std::cout << std::format("Intraday merge: {} events from hourly and half-hourly feeds, in time order: {}\n", 
+        timestamps.size(), ordered ? "yes" : "NO");
+    
+    return ordered ? 0 : 1;
+}
+
+// Floating-point vs fixed-point (cents) accounting, and tick-encoded prices
+static int run_fixed_point(const std::string& filename) {
+    auto load = DataLoader::loadCSV_safe(filename);
+    if (!load.is_success()) {
+        std::cout << std::format("Error: {}\n", load.get_error());
+        return 1;
+    }
+    
+    TickSeries ticks = TickSeries::encode(load.data, TickScale{100});   // Whole cents
+    std::cout << std::format("Tick series: {} bars, price columns {} bytes (doubles: {} bytes)\n\n", 
+        ticks.size(), ticks.price_bytes(), ticks.double_price_bytes());
+    
+    Backtester floating(std::make_unique<VectorBarSource>(load.data), 100000.0);
+    Backtester fixed(std::make_unique<TickBarSource>(ticks), 100000.0);
+    fixed.set_accounting(Accounting::FixedPoint);
+    
+    std::cout << std::format("{:<20} {:<16} {:<16} {:<10}\n", "Strategy", "Float Return %", "Fixed Return %", "Trades");
+    auto compare = [&](const std::string& name, auto make_strategy) {
+        auto a = make_strategy();
+        auto b = make_strategy();
+        auto float_result = floating.run_backtest(a);
+        auto fixed_result = fixed.run_backtest(b);
+        std::cout << std::format("{:<20} {:<16.6f} {:<16.6f} {}/{}\n", name, float_result.total_return, 
+            fixed_result.total_return, float_result.all_trades.size(), fixed_result.all_trades.size());
+    };
+    compare("SMA Crossover", [] { return SMACrossoverStrategy(10, 30); });
+    compare("EMA Crossover", [] { return EMACrossoverStrategy(12, 26); });
+    compare("Mean Reversion", [] { return MeanReversionStrategy(20, 2.0); });
+    
+    return 0;
+}
+
+// CSV streaming (prefetch thread, small chunks) checked against the in-memory path
+static int run_stream(const std::string& filename) {
+    Backtester in_memory(filename, 100000.0);
+    
+    // Chunks of 1 and 7 bars are shorter than every strategy window
+    const size_t chunk_sizes[] = {1, 7, 4096};
+    const std::pair<std::string, std::string> ranges[] = {{"", ""}, {"03/01/2021", "09/30/2021"}};
+    
+    size_t runs = 0;
+    size_t mismatches = 0;
+    auto compare = [&](const std::string& name, auto make_strategy) {
+        for (const auto& [start, end] : ranges) {
+            auto reference = make_strategy();
+            BacktestResult expected = in_memory.run_backtest(reference, start, end);
+            for (size_t chunk_size : chunk_sizes) {
+                Backtester streaming(std::make_unique<CsvBarSource>(filename), 100000.0, chunk_size);
+                auto strategy = make_strategy();
+                BacktestResult result = streaming.run_backtest(strategy, start, end);
+                
+                bool same = result.total_return == expected.total_return && result.sharpe_ratio == expected.sharpe_ratio &&
+                            result.max_drawdown == expected.max_drawdown && result.win_rate == expected.win_rate &&
+                            result.avg_trade_pnl == expected.avg_trade_pnl && result.bars_processed == expected.bars_processed &&
+                            result.all_trades.size() == expected.all_trades.size();
+                runs++;
+                if (!same) {
+                    mismatches++;
+                    std::cout << std::format("MISMATCH {} [{}, {}] chunk {}: {:.6f}% / {} trades vs {:.6f}% / {} trades\n",
+                        name, start, end, chunk_size, result.total_return, result.all_trades.size(),
+                        expected.total_return, expected.all_trades.size());
+                }
+            }
+        }
+    };
+    compare("SMA Crossover", [] { return SMACrossoverStrategy(10, 30); });
+    compare("EMA Crossover", [] { return EMACrossoverStrategy(12, 26); });
+    compare("Mean Reversion", [] { return MeanReversionStrategy(20, 2.0); });
+    
+    std::cout << std::format("Streamed runs identical to in-memory runs: {} ({} of {} differ)\n",
+        mismatches == 0 ? "yes" : "NO", mismatches, runs);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Hand-written strategies vs their signal DSL equivalents
+static int run_benchmark(const std::string& filename, int reps) {
+    Backtester backtester(filename, 100000.0);
+    constexpr int BATCHES = 10;
+    size_t mismatches = 0;
+    
+    auto report = [&](const std::string& name, auto hand_written, auto dsl) {
+        // Interleave batches, swapping which side goes first, and keep each side's
+        // fastest batch so neither load drift nor run order favours one of them
+        int batch_reps = std::max(reps / BATCHES, 1);
+        BacktestResult hand_result, dsl_result;
+        double hand_us = std::numeric_limits<double>::max();
+        double dsl_us = std::numeric_limits<double>::max();
+        auto time_hand = [&] { hand_us = std::min(hand_us, time_strategy(backtester, hand_written, batch_reps, hand_result)); };
+        auto time_dsl = [&] { dsl_us = std::min(dsl_us, time_strategy(backtester, dsl, batch_reps, dsl_result)); };
+        for (int batch = 0; batch < BATCHES; ++batch) {
+            if (batch % 2 == 0) {
+                time_hand();
+                time_dsl();
+            } else {
+                time_dsl();
+                time_hand();
+            }
+        }
+        bool same = hand_result.total_return == dsl_result.total_return && 
+                    hand_result.all_trades.size() == dsl_result.all_trades.size();
+        if (!same) mismatches++;
+        std::cout << std::format("{:<20} {:<14.1f} {:<14.1f} {:<12}\n", 
+            name, hand_us, dsl_us, same ? "yes" : "NO");
+    };
+    
+    std::cout << std::format("\n=== Benchmark ({} runs each, best of {} batches) ===\n", reps, BATCHES);
+    std::cout << std::format("{:<20} {:<14} {:<14} {:<12}\n", "Strategy", "Hand (us)", "DSL (us)", "Same Result");
+    report("SMA Crossover", SMACrossoverStrategy(10, 30), signals::sma_crossover(10, 30));
+    report("EMA Crossover", EMACrossoverStrategy(12, 26), signals::ema_crossover(12, 26));
+    report("Mean Reversion", MeanReversionStrategy(20, 2.0), signals::mean_reversion(20, 2.0));
+    
+    // Parity on a long cent-rounded walk, where windows often hold equal closes and
+    // closes land exactly on a band, so any difference in the arithmetic shows up
+    constexpr size_t PARITY_BARS = 200000;
+    std::vector<MarketData> walk = random_walk_bars(PARITY_BARS);
+    Backtester walk_backtester(std::make_unique<VectorBarSource>(walk), 100000.0);
+    size_t configs = 0;
+    size_t parity_mismatches = 0;
+    auto parity = [&](const std::string& name, auto hand_written, auto dsl) {
+        BacktestResult hand_result = walk_backtester.run_backtest(hand_written);
+        BacktestResult dsl_result = walk_backtester.run_backtest(dsl);
+        configs++;
+        if (hand_result.total_return != dsl_result.total_return ||
+            hand_result.all_trades.size() != dsl_result.all_trades.size()) {
+            parity_mismatches++;
+            std::cout << std::format("MISMATCH {}: hand {:.4f}% / {} trades, DSL {:.4f}% / {} trades\n", name,
+                hand_result.total_return, hand_result.all_trades.size(), dsl_result.total_return, dsl_result.all_trades.size());
+        }
+    };
+    for (auto [short_w, long_w] : {std::pair{2, 20}, {2, 50}, {5, 20}, {10, 30}, {20, 100}}) {
+        parity(std::format("SMA({}, {})", short_w, long_w), SMACrossoverStrategy(short_w, long_w), 
+               signals::sma_crossover(short_w, long_w));
+        parity(std::format("EMA({}, {})", short_w, long_w), EMACrossoverStrategy(short_w, long_w), 
+               signals::ema_crossover(short_w, long_w));
+    }
+    for (int period : {2, 5, 20, 60}) {
+        for (double multiplier : {1.0, 2.0}) {
+            parity(std::format("MR({}, {})", period, multiplier), MeanReversionStrategy(period, multiplier), 
+                   signals::mean_reversion(period, multiplier));
+        }
+    }
+    std::cout << std::format("\nHand-written vs DSL over a {}-bar random walk: {} of {} configs identical\n",
+        PARITY_BARS, configs - parity_mismatches, configs);
+    
+    return mismatches == 0 && parity_mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
     std::cout << std::format("Quantitative Trading Simulator - Backtesting Engine\n\n");
     
+    // ./main --sweep [workers] [store] runs a multi-process parameter sweep instead
+    // ./main --query [store] summarizes a saved sweep
+    // ./main --sweep-check [workers] kills and hangs workers mid-sweep and compares against a clean sweep
+    // ./main --benchmark [runs] times hand-written strategies against the signal DSL
+    // ./main --optimize compares adaptive parameter search against the full grid
+    // ./main --fixed-point compares floating-point and fixed-point (cents) accounting
+    // ./main --events [feeds] merges QQQM, SPY and derived feeds with the coroutine scheduler
+    // ./main --cross-section [symbols] [bars] ranks a synthetic universe into decile portfolios
+    // ./main --risk [assets] [bars] times the rolling risk engine and checks it against brute force
+    // ./main --stream checks CSV streaming in small chunks against the in-memory backtest
+    if (argc > 1) {
+        std::string mode = argv[1];
+        try {
+            if (mode == "--sweep") {
+                return run_sweep("data/qqqm.csv", argc > 2 ? std::stoul(argv[2]) : 4, 
+                                 argc > 3 ? argv[3] : "output/sweep_results.bin");
+            }
+            if (mode == "--sweep-check") {
+                return run_sweep_check("data/qqqm.csv", argc > 2 ? std::stoul(argv[2]) : 4);
+            }
+            if (mode == "--query") {
+                return run_query(argc > 2 ? argv[2] : "output/sweep_results.bin");
+            }
+            if (mode == "--fixed-point") {
+                return run_fixed_point("data/qqqm.csv");
+            }
+            if (mode == "--events") {
+                return run_events("data/qqqm.csv", "data/spy.csv", argc > 2 ? std::stoul(argv[2]) : 0);
+            }
+            if (mode == "--risk") {
+                return run_risk(argc > 2 ? std::stoul(argv[2]) : 500, argc > 3 ? std::stoul(argv[3]) : 2520, 252);
+            }
+            if (mode == "--cross-section") {
+                return run_cross_section(argc > 2 ? std::stoul(argv[2]) : 5000, argc > 3 ? std::stoul(argv[3]) : 5040);
+            }
+            if (mode == "--stream") {
+                return run_stream("data/qqqm.csv");
+            }
+            if (mode == "--optimize") {
+                return run_optimize("data/qqqm.csv");
+            }
+            if (mode == "--benchmark") {
+                return run_benchmark("data/qqqm.csv", argc > 2 ? std::stoi(argv[2]) : 1000);
+            }
+        } catch (const std::exception& e) {
+            std::cout << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+    }
+    
     try {
         // Load QQQM data with 100k capital
         std::string filename = "data/qqqm.csv";
@@ -73,7 +866,7 @@ int main() {
             price_range.first, price_range.second);
         std::cout << std::format("Data period: {} to {}\n", 
             market_data.back().date, market_data.front().date);
-        
+    
     } catch (const std::exception& e) {
         std::cout << std::format("Error: {}\n", e.what());
         return 1;
@@ -3,13 +3,27 @@
 # Build and run script for trade_sim
 echo "Building trade simulator..."
 
-g++ -std=c++20 -fconcepts -fcoroutines -g -Wall -Wextra \
+g++ -std=c++20 -fconcepts -fcoroutines -pthread -g -Wall -Wextra \
     main.cpp \
     src/data_loader.cpp \
     src/backtester.cpp \
+        src/bar_source.cpp \
+        src/fixed_point.cpp \
+        src/run_arena.cpp \
+        src/alloc_audit.cpp \
+        src/indicators/indicator_cache.cpp \
     src/strategies/sma_strategy.cpp \
     src/strategies/ema_strategy.cpp \
     src/strategies/mean_reversion_strategy.cpp \
+        src/sweep/shared_dataset.cpp \
+        src/sweep/sweep_job.cpp \
+        src/sweep/sweep_coordinator.cpp \
+        src/sweep/adaptive_optimizer.cpp \
+        src/sweep/results_store.cpp \
+        src/risk/risk_engine.cpp \
+        src/events/event_scheduler.cpp \
+        src/factors/panel_data.cpp \
+        src/factors/cross_section.cpp \
     -o main
 
 if [ $? -eq 0 ]; then
@@ -0,0 +1,48 @@
+#include "alloc_audit.h"
+
+#ifdef TRADE_SIM_ALLOC_AUDIT
+#include <new>
+#include <cstdlib>
+
+namespace {
+
+thread_local size_t allocation_count = 0;
+thread_local size_t allocated_bytes = 0;
+
+void* counted_alloc(size_t size, size_t alignment) {
+    allocation_count++;
+    allocated_bytes += size;
+    
+    if (size == 0) size = 1;
+    void* ptr = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+}
+
+void* operator new(size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return counted_alloc(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return counted_alloc(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+size_t AllocationAudit::thread_allocations() { return allocation_count; }
+size_t AllocationAudit::thread_bytes() { return allocated_bytes; }
+
+#else
+
+size_t AllocationAudit::thread_allocations() { return 0; }
+size_t AllocationAudit::thread_bytes() { return 0; }
+
+#endif
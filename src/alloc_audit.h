@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+// Heap allocation counting for catching allocation regressions in the
+// backtest hot loop. Compiled in with -DTRADE_SIM_ALLOC_AUDIT (the debug
+// build does this), which replaces the global operator new; otherwise every
+// count reads as zero and nothing is intercepted.
+class AllocationAudit {
+public:
+    static constexpr bool enabled() {
+#ifdef TRADE_SIM_ALLOC_AUDIT
+        return true;
+#else
+        return false;
+#endif
+    }
+    
+    // Allocations made by the calling thread so far
+    static size_t thread_allocations();
+    static size_t thread_bytes();
+};
+
+// Counts the calling thread's allocations between construction and the query
+class AllocationScope {
+private:
+    size_t start_allocations;
+    size_t start_bytes;
+    
+public:
+    AllocationScope() 
+        : start_allocations(AllocationAudit::thread_allocations()), start_bytes(AllocationAudit::thread_bytes()) {}
+    
+    size_t allocations() const { return AllocationAudit::thread_allocations() - start_allocations; }
+    size_t bytes() const { return AllocationAudit::thread_bytes() - start_bytes; }
+};
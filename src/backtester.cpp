@@ -9,7 +9,34 @@
 #include <cmath>
 
 // Portfolio management implementation
-void Portfolio::buy(const std::string& date, const std::string& symbol, double price, long quantity, double commission) {
+void Portfolio::reset(double initial) {
+    cash = initial;
+    position = 0;
+    total_value = initial;
+    initial_cash = initial;
+    cash_cents = to_cents(initial);
+    value_cents = cash_cents;
+    initial_cents = cash_cents;
+    
+    // Swap out the storage as well, so nothing points into a rewound arena
+    std::pmr::vector<Trade>(trades.get_allocator()).swap(trades);
+}
+
+void Portfolio::buy(std::string_view date, std::string_view symbol, double price, long quantity, double commission) {
+    if (accounting == Accounting::FixedPoint) {
+        Cents price_cents = to_cents(price);
+        Cents commission_cents = to_cents(commission);
+        Cents cost = price_cents * quantity + commission_cents;
+        if (cost <= cash_cents) {
+            cash_cents -= cost;
+            cash = to_dollars(cash_cents);
+            position += quantity;
+            trades.emplace_back(date, symbol, "BUY", to_dollars(price_cents), quantity, 
+                                to_dollars(-commission_cents), to_dollars(commission_cents));
+        }
+        return;
+    }
+    
     double cost = price * quantity + commission;
     if (cost <= cash) {
         cash -= cost;
@@ -18,7 +45,20 @@ void Portfolio::buy(const std::string& date, const std::string& symbol, double p
     }
 }
 
-void Portfolio::sell(const std::string& date, const std::string& symbol, double price, long quantity, double commission) {
+void Portfolio::sell(std::string_view date, std::string_view symbol, double price, long quantity, double commission) {
+    if (accounting == Accounting::FixedPoint) {
+        if (quantity <= position) {
+            Cents price_cents = to_cents(price);
+            Cents commission_cents = to_cents(commission);
+            cash_cents += price_cents * quantity - commission_cents;
+            cash = to_dollars(cash_cents);
+            position -= quantity;
+            trades.emplace_back(date, symbol, "SELL", to_dollars(price_cents), quantity, 
+                                to_dollars(-commission_cents), to_dollars(commission_cents));
+        }
+        return;
+    }
+    
     if (quantity <= position) {
         double proceeds = price * quantity - commission;
         cash += proceeds;
@@ -28,40 +68,51 @@ void Portfolio::sell(const std::string& date, const std::string& symbol, double
 }
 
 void Portfolio::update_value(double current_price) {
+    if (accounting == Accounting::FixedPoint) {
+        value_cents = cash_cents + position * to_cents(current_price);
+        total_value = to_dollars(value_cents);
+        return;
+    }
     total_value = cash + (position * current_price);
 }
 
 double Portfolio::get_total_return() const {
+    if (accounting == Accounting::FixedPoint) {
+        return static_cast<double>(value_cents - initial_cents) / static_cast<double>(initial_cents) * 100.0;
+    }
     return (total_value - initial_cash) / initial_cash * 100.0;
 }
 
 double Portfolio::get_sharpe_ratio(const std::vector<MarketData>& data) const {
     if (data.size() < 2) return 0.0;
     
-    // Calculate daily returns
-    std::vector<double> returns;
-    for (size_t i = 1; i < data.size(); ++i) {
-        double daily_return = (data[i].close - data[i-1].close) / data[i-1].close;
-        returns.push_back(daily_return);
-    }
-    
-    if (returns.empty()) return 0.0;
-    
-    // Calculate mean and standard deviation
-    double mean = std::accumulate(returns.begin(), returns.end(), 0.0) / returns.size();
-    double variance = 0.0;
-    for (double ret : returns) {
-        variance += (ret - mean) * (ret - mean);
+    // Same accumulator the streaming path uses, so both report identical values
+    ReturnStats returns;
+    for (const auto& bar : data) {
+        returns.add(bar.close);
     }
-    variance /= returns.size();
-    double std_dev = std::sqrt(variance);
     
-    return std_dev > 0 ? mean / std_dev : 0.0;
+    return returns.get_sharpe_ratio();
 }
 
 double Portfolio::get_max_drawdown() const {
     if (trades.empty()) return 0.0;
     
+    if (accounting == Accounting::FixedPoint) {
+        // Trade prices and commissions are whole cents here, so the replay is exact
+        Cents peak = initial_cents;
+        Cents current = initial_cents;
+        double max_dd = 0.0;
+        for (const auto& trade : trades) {
+            Cents notional = to_cents(trade.price) * trade.quantity;
+            Cents commission = to_cents(trade.commission);
+            current += trade.action == "BUY" ? -(notional + commission) : notional - commission;
+            peak = std::max(peak, current);
+            max_dd = std::max(max_dd, static_cast<double>(peak - current) / static_cast<double>(peak));
+        }
+        return max_dd * 100.0;
+    }
+    
     double peak = initial_cash; 
     double max_dd = 0.0;
     double current_value = initial_cash;
@@ -99,6 +150,24 @@ double Portfolio::get_win_rate() const {
     return static_cast<double>(winning_trades) / trades.size() * 100.0;
 }
 
+double Portfolio::get_avg_trade_pnl() const {
+    if (trades.empty()) return 0.0;
+    
+    if (accounting == Accounting::FixedPoint) {
+        Cents total_pnl = 0;
+        for (const auto& trade : trades) {
+            total_pnl += to_cents(trade.pnl);
+        }
+        return to_dollars(total_pnl) / trades.size();
+    }
+    
+    double total_pnl = 0.0;
+    for (const auto& trade : trades) {
+        total_pnl += trade.pnl;
+    }
+    return total_pnl / trades.size();
+}
+
 // BacktestResult implementation
 void BacktestResult::export_trades_csv(const std::string& filename) const {
     std::ofstream file(filename);
@@ -142,11 +211,14 @@ void BacktestResult::print_summary() const {
     std::cout << std::format("Avg Trade PnL: ${:.2f}\n", avg_trade_pnl);
     std::cout << std::format("Total Trades: {}\n", all_trades.size());
     std::cout << std::format("Execution Time: {} microseconds\n", execution_time.count());
+    if (AllocationAudit::enabled()) {
+        std::cout << std::format("Hot Loop Heap Allocations: {}\n", hot_loop_allocations);
+    }
 }
 
 // Backtester implementation
 Backtester::Backtester(const std::string& data_file, double initial_cash) 
-    : portfolio(initial_cash), initial_cash(initial_cash) {
+    : portfolio(initial_cash, &arena), initial_cash(initial_cash), chunk_size(0), hook_interval(1) {
     
     auto result = DataLoader::loadCSV_safe(data_file);
     if (!result.is_success()) {
@@ -156,3 +228,49 @@ Backtester::Backtester(const std::string& data_file, double initial_cash)
     market_data = std::move(result.data);
     std::cout << std::format("Loaded {} market data points\n", market_data.size());
 }
+
+Backtester::Backtester(std::unique_ptr<BarSource> source, double initial_cash, size_t chunk_size)
+    : portfolio(initial_cash, &arena), initial_cash(initial_cash),
+      bar_source(std::move(source)), chunk_size(std::max<size_t>(chunk_size, 1)), hook_interval(1) {
+    
+    if (!bar_source) {
+        throw std::invalid_argument("Streaming backtester requires a bar source");
+    }
+}
+
+void Backtester::set_progress_hook(ProgressHook hook, size_t interval) {
+    progress_hook = std::move(hook);
+    hook_interval = std::max<size_t>(interval, 1);
+}
+
+BacktestResult Backtester::build_result(std::chrono::microseconds execution_time, double sharpe_ratio, 
+                                        size_t bars_processed, bool cancelled, size_t hot_loop_allocations) const {
+    // Calculate metrics
+    BacktestResult result;
+    result.final_portfolio.cash = portfolio.cash;
+    result.final_portfolio.position = portfolio.position;
+    result.final_portfolio.total_value = portfolio.total_value;
+    result.final_portfolio.initial_cash = portfolio.initial_cash;
+    result.final_portfolio.accounting = portfolio.accounting;
+    result.final_portfolio.cash_cents = portfolio.cash_cents;
+    result.final_portfolio.value_cents = portfolio.value_cents;
+    result.final_portfolio.initial_cents = portfolio.initial_cents;
+    
+    // Trades are copied out of the run arena onto the heap, since the arena is
+    // rewound by the next run. This is after the audited bar loop.
+    result.final_portfolio.trades.assign(portfolio.trades.begin(), portfolio.trades.end());
+    result.all_trades.reserve(portfolio.trades.size());
+    result.all_trades.assign(portfolio.trades.begin(), portfolio.trades.end());
+    result.total_return = portfolio.get_total_return();
+    result.annualized_return = result.total_return; // Simplified - would need actual time period
+    result.sharpe_ratio = sharpe_ratio;
+    result.max_drawdown = portfolio.get_max_drawdown();
+    result.win_rate = portfolio.get_win_rate();
+    result.avg_trade_pnl = portfolio.get_avg_trade_pnl();
+    result.execution_time = execution_time;
+    result.bars_processed = bars_processed;
+    result.cancelled = cancelled;
+    result.hot_loop_allocations = hot_loop_allocations;
+    
+    return result;
+}
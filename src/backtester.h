@@ -1,10 +1,19 @@
 #pragma once
 #include "data_loader.h"
+#include "bar_source.h"
+#include "run_arena.h"
+#include "alloc_audit.h"
+#include "fixed_point.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory_resource>
 #include <functional>
 #include <chrono>
 #include <expected>
+#include <memory>
+#include <optional>
+#include <cmath>
 
 // Forward declarations
 struct Trade;
@@ -16,11 +25,14 @@ concept TradingStrategy = requires(T strategy) {
     strategy.on_bar(std::declval<const MarketData&>(), std::declval<Portfolio&>());
 };
 
-// Trade execution record
+// Trade execution record. Allocator-aware, so trades stored in a pmr
+// container keep their strings in the same memory resource.
 struct Trade {
-    std::string date;
-    std::string symbol;
-    std::string action;  // "BUY" or "SELL"
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+    
+    std::pmr::string date;
+    std::pmr::string symbol;
+    std::pmr::string action;  // "BUY" or "SELL"
     double price;
     long quantity;
     double pnl;
@@ -28,25 +40,87 @@ struct Trade {
     
     
     template<Numeric T>
-    Trade(const std::string& d, const std::string& s, const std::string& a, T p, long q, T pnl_val = 0.0, T comm = 0.0)
-        : date(d), symbol(s), action(a), price(static_cast<double>(p)), quantity(q), 
+    Trade(std::string_view d, std::string_view s, std::string_view a, T p, long q, T pnl_val = 0.0, T comm = 0.0,
+          const allocator_type& alloc = {})
+        : date(d, alloc), symbol(s, alloc), action(a, alloc), price(static_cast<double>(p)), quantity(q), 
           pnl(static_cast<double>(pnl_val)), commission(static_cast<double>(comm)) {}
+    
+    Trade(const Trade& other, const allocator_type& alloc = {})
+        : date(other.date, alloc), symbol(other.symbol, alloc), action(other.action, alloc), price(other.price),
+          quantity(other.quantity), pnl(other.pnl), commission(other.commission) {}
+    
+    Trade(Trade&& other, const allocator_type& alloc)
+        : date(std::move(other.date), alloc), symbol(std::move(other.symbol), alloc), action(std::move(other.action), alloc),
+          price(other.price), quantity(other.quantity), pnl(other.pnl), commission(other.commission) {}
+    
+    Trade(Trade&&) noexcept = default;
+    Trade& operator=(const Trade&) = default;
+    Trade& operator=(Trade&&) = default;
+};
+
+// Running daily-return statistics (Welford), so the Sharpe ratio can be
+// computed in one pass without keeping the price series around
+struct ReturnStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double prev_close = 0.0;
+    bool has_prev = false;
+    
+    void add(double close) {
+        if (has_prev) {
+            double daily_return = (close - prev_close) / prev_close;
+            ++count;
+            double delta = daily_return - mean;
+            mean += delta / count;
+            m2 += delta * (daily_return - mean);
+        }
+        prev_close = close;
+        has_prev = true;
+    }
+    
+    double get_sharpe_ratio() const {
+        if (count == 0) return 0.0;
+        double std_dev = std::sqrt(m2 / count);
+        return std_dev > 0 ? mean / std_dev : 0.0;
+    }
+};
+
+// How Portfolio keeps its books. FixedPoint rounds every fill to whole cents
+// and does all cash/value arithmetic in int64 cents, so the same trades give
+// bit-identical results on any build or thread schedule. The double fields
+// are kept in sync for strategies and hooks that read them.
+enum class Accounting {
+    FloatingPoint,
+    FixedPoint
 };
 
-// Portfolio state
+// Portfolio state. Trades live in `resource` (the backtester's per-run arena
+// during a run, the default heap otherwise).
 struct Portfolio {
     double cash;
     long position;  // Number of shares held
     double total_value;
     double initial_cash;
-    std::vector<Trade> trades;
+    std::pmr::vector<Trade> trades;
     
-    Portfolio(double initial_cash = 100000.0) 
-        : cash(initial_cash), position(0), total_value(initial_cash), initial_cash(initial_cash) {}
+    // Fixed-point books (authoritative when accounting == FixedPoint)
+    Accounting accounting;
+    Cents cash_cents;
+    Cents value_cents;
+    Cents initial_cents;
+    
+    Portfolio(double initial_cash = 100000.0, std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+              Accounting accounting = Accounting::FloatingPoint) 
+        : cash(initial_cash), position(0), total_value(initial_cash), initial_cash(initial_cash), trades(resource),
+          accounting(accounting), cash_cents(to_cents(initial_cash)), value_cents(cash_cents), initial_cents(cash_cents) {}
+    
+    // Start over with `initial_cash`, dropping trades and their storage but keeping the resource and accounting mode
+    void reset(double initial_cash);
     
     // Portfolio management methods
-    void buy(const std::string& date, const std::string& symbol, double price, long quantity, double commission = 0.0);
-    void sell(const std::string& date, const std::string& symbol, double price, long quantity, double commission = 0.0);
+    void buy(std::string_view date, std::string_view symbol, double price, long quantity, double commission = 0.0);
+    void sell(std::string_view date, std::string_view symbol, double price, long quantity, double commission = 0.0);
     void update_value(double current_price);
     
     // Performance metrics
@@ -54,11 +128,12 @@ struct Portfolio {
     double get_sharpe_ratio(const std::vector<MarketData>& data) const;
     double get_max_drawdown() const;
     double get_win_rate() const;
+    double get_avg_trade_pnl() const;
 };
 
 // Backtest result with comprehensive metrics
 struct BacktestResult {
-    Portfolio final_portfolio;
+    Portfolio final_portfolio;      // Closing books, with the trades on the heap
     std::vector<Trade> all_trades;
     double total_return;
     double annualized_return;
@@ -67,6 +142,9 @@ struct BacktestResult {
     double win_rate;
     double avg_trade_pnl;
     std::chrono::microseconds execution_time;
+    size_t bars_processed;
+    bool cancelled;     // Stopped early by the progress hook
+    size_t hot_loop_allocations;    // Heap allocations inside the bar loop, not counting result building (audit builds only)
     
     // Export methods for analysis
     void export_trades_csv(const std::string& filename) const;
@@ -74,68 +152,145 @@ struct BacktestResult {
     void print_summary() const;
 };
 
+// Called every few bars with the number of bars processed so far and the
+// marked-to-market portfolio; returning false cancels the run
+using ProgressHook = std::function<bool(size_t bars_processed, const Portfolio& portfolio)>;
+
 // Main backtesting engine
 class Backtester {
 private:
     std::vector<MarketData> market_data;
+    RunArena arena;     // Declared before portfolio, which allocates from it
     Portfolio portfolio;
     double initial_cash;
     
+    // Streaming mode: bars are pulled from here chunk by chunk instead of market_data
+    std::unique_ptr<BarSource> bar_source;
+    size_t chunk_size;
+    std::vector<MarketData> chunk;  // Reused across runs
+    
+    ProgressHook progress_hook;
+    size_t hook_interval;
+    
+    BacktestResult build_result(std::chrono::microseconds execution_time, double sharpe_ratio, 
+                                size_t bars_processed, bool cancelled, size_t hot_loop_allocations) const;
+    
+    // Fresh portfolio backed by a rewound arena
+    void begin_run() {
+        portfolio.reset(initial_cash);
+        arena.reset();
+    }
+    
+    // Bookkeeping after the strategy has seen a bar; false once the progress hook cancels the run
+    bool finish_bar(const MarketData& bar, ReturnStats& returns, size_t& bars_processed) {
+        portfolio.update_value(bar.close);
+        returns.add(bar.close);
+        bars_processed++;
+        
+        if (progress_hook && bars_processed % hook_interval == 0) {
+            return progress_hook(bars_processed, portfolio);
+        }
+        return true;
+    }
+    
+    template<TradingStrategy T>
+    BacktestResult run_backtest_streaming(T& strategy, const std::string& start_date, const std::string& end_date) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        bool filter = !start_date.empty() || !end_date.empty();
+        
+        // Reset portfolio and rewind the source
+        begin_run();
+        ReturnStats returns;
+        size_t bars_processed = 0;
+        bool cancelled = false;
+        bar_source->reset();
+        
+        // Strategy consumes one chunk while the prefetcher reads the next
+        std::optional<ChunkPrefetcher> prefetcher;
+        if (!bar_source->is_resident()) {
+            prefetcher.emplace(*bar_source, chunk_size);
+        }
+        auto next_chunk = [&](std::vector<MarketData>& chunk) {
+            return prefetcher ? prefetcher->next(chunk) : bar_source->next_chunk(chunk, chunk_size);
+        };
+        
+        AllocationScope allocations;
+        while (!cancelled && next_chunk(chunk)) {
+            for (const auto& bar : chunk) {
+                if (filter && !DataLoader::in_date_range(bar, start_date, end_date)) continue;
+                
+                strategy.on_bar(bar, portfolio);
+                if (!finish_bar(bar, returns, bars_processed)) {
+                    cancelled = true;
+                    break;
+                }
+            }
+        }
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+        
+        return build_result(execution_time, returns.get_sharpe_ratio(), bars_processed, cancelled, allocations.allocations());
+    }
+    
 public:
     // Constructor with data loading
     explicit Backtester(const std::string& data_file, double initial_cash = 100000.0);
     
+    // Streaming constructor: memory stays bounded by two chunks of `chunk_size` bars
+    explicit Backtester(std::unique_ptr<BarSource> source, double initial_cash = 100000.0, size_t chunk_size = 4096);
+    
     // Main backtesting method
     template<TradingStrategy T>
     BacktestResult run_backtest(T& strategy, const std::string& start_date = "", const std::string& end_date = "") {
+        if (bar_source) {
+            return run_backtest_streaming(strategy, start_date, end_date);
+        }
+        
         auto start_time = std::chrono::high_resolution_clock::now();
         
-        // Filter data by date range if specified
-        std::vector<MarketData> filtered_data = market_data;
-        if (!start_date.empty() || !end_date.empty()) {
-            filtered_data = DataLoader::filter_by_date_range(market_data, start_date, end_date);
-        }
+        // Date range is applied in place (same predicate as filter_by_date_range) instead of copying
+        bool filter = !start_date.empty() || !end_date.empty();
         
         // Reset portfolio
-        portfolio = Portfolio(initial_cash);
+        begin_run();
+        ReturnStats returns;
+        size_t bars_processed = 0;
+        bool cancelled = false;
         
         // Run strategy on each bar
-        for (const auto& bar : filtered_data) {
+        AllocationScope allocations;
+        for (const auto& bar : market_data) {
+            if (filter && !DataLoader::in_date_range(bar, start_date, end_date)) continue;
+            
             strategy.on_bar(bar, portfolio);
-            portfolio.update_value(bar.close);
+            if (!finish_bar(bar, returns, bars_processed)) {
+                cancelled = true;
+                break;
+            }
         }
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         
-        // Calculate metrics
-        BacktestResult result;
-        result.final_portfolio = portfolio;
-        result.all_trades = portfolio.trades;
-        result.total_return = portfolio.get_total_return();
-        result.annualized_return = result.total_return; // Simplified - would need actual time period
-        result.sharpe_ratio = portfolio.get_sharpe_ratio(filtered_data);
-        result.max_drawdown = portfolio.get_max_drawdown();
-        result.win_rate = portfolio.get_win_rate();
-        result.execution_time = execution_time;
-        
-        // Calculate average trade PnL
-        if (!portfolio.trades.empty()) {
-            double total_pnl = 0.0;
-            for (const auto& trade : portfolio.trades) {
-                total_pnl += trade.pnl;
-            }
-            result.avg_trade_pnl = total_pnl / portfolio.trades.size();
-        }
-        
-        return result;
+        return build_result(execution_time, returns.get_sharpe_ratio(), bars_processed, cancelled, allocations.allocations());
     }
     
+    // Progress / cancellation hook, invoked every `interval` bars of each run
+    void set_progress_hook(ProgressHook hook, size_t interval = 1);
+    void clear_progress_hook() { progress_hook = nullptr; }
+    
     // Utility methods
     void set_commission(double commission_rate);
+    
+    // Applies from the next run on
+    void set_accounting(Accounting mode) { portfolio.accounting = mode; }
+    Accounting get_accounting() const { return portfolio.accounting; }
     void set_slippage(double slippage_rate);
     
-    // Data access
+    // Data access (market_data is empty in streaming mode)
+    bool is_streaming() const { return bar_source != nullptr; }
     const std::vector<MarketData>& get_market_data() const { return market_data; }
     const Portfolio& get_portfolio() const { return portfolio; }
 };
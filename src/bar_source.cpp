@@ -0,0 +1,120 @@
+#include "bar_source.h"
+#include <format>
+#include <stdexcept>
+#include <algorithm>
+
+// CsvBarSource implementation
+CsvBarSource::CsvBarSource(const std::string& filename)
+    : filename(filename), line_number(0) {
+    open();
+}
+
+void CsvBarSource::open() {
+    file.close();
+    file.clear();
+    file.open(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error(std::format("Could not open file: {}", filename));
+    }
+    
+    // Skip header line
+    line_number = 0;
+    if (!std::getline(file, line)) {
+        throw std::runtime_error("File is empty or has no header");
+    }
+    line_number++;
+}
+
+bool CsvBarSource::next_chunk(std::vector<MarketData>& out, size_t max_bars) {
+    out.clear();
+    
+    std::string error_message;
+    while (out.size() < max_bars && std::getline(file, line)) {
+        line_number++;
+        
+        MarketData row;
+        if (DataLoader::parse_csv_line(line, line_number, row, error_message) != LoadStatus::Success) {
+            throw std::runtime_error(std::format("Failed to stream data: {}", error_message));
+        }
+        out.push_back(std::move(row));
+    }
+    
+    return !out.empty();
+}
+
+void CsvBarSource::reset() {
+    open();
+}
+
+// VectorBarSource implementation
+bool VectorBarSource::next_chunk(std::vector<MarketData>& out, size_t max_bars) {
+    out.clear();
+    
+    size_t count = cursor < last ? std::min(max_bars, last - cursor) : 0;
+    out.insert(out.end(), data.begin() + cursor, data.begin() + cursor + count);
+    cursor += count;
+    
+    return !out.empty();
+}
+
+// ChunkPrefetcher implementation
+ChunkPrefetcher::ChunkPrefetcher(BarSource& source, size_t chunk_size)
+    : source(source), chunk_size(std::max<size_t>(chunk_size, 1)),
+      back_ready(false), exhausted(false), stopping(false) {
+    back_buffer.reserve(this->chunk_size);
+    worker = std::thread(&ChunkPrefetcher::fill_loop, this);
+}
+
+ChunkPrefetcher::~ChunkPrefetcher() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+void ChunkPrefetcher::fill_loop() {
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this] { return !back_ready || stopping; });
+            if (stopping) return;
+        }
+        
+        // The consumer never touches back_buffer while back_ready is false,
+        // so the read happens outside the lock and overlaps with on_bar work
+        bool has_data = false;
+        std::exception_ptr failure;
+        try {
+            has_data = source.next_chunk(back_buffer, chunk_size);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        
+        std::lock_guard lock(mutex);
+        if (failure || !has_data) {
+            error = failure;
+            exhausted = true;
+            cv.notify_all();
+            return;
+        }
+        back_ready = true;
+        cv.notify_all();
+    }
+}
+
+bool ChunkPrefetcher::next(std::vector<MarketData>& chunk) {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [this] { return back_ready || exhausted; });
+    
+    if (!back_ready) {
+        if (error) std::rethrow_exception(error);
+        return false;
+    }
+    
+    std::swap(chunk, back_buffer);
+    back_ready = false;
+    cv.notify_all();
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "data_loader.h"
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+// Pull-based source of market data bars, consumed in fixed-size chunks
+class BarSource {
+public:
+    virtual ~BarSource() = default;
+    
+    // Replace `out` with up to `max_bars` bars; returns false once the source is exhausted
+    virtual bool next_chunk(std::vector<MarketData>& out, size_t max_bars) = 0;
+    
+    // Rewind to the first bar so the source can be replayed by another backtest
+    virtual void reset() = 0;
+    
+    // Sources already backed by memory gain nothing from a prefetch thread
+    virtual bool is_resident() const { return false; }
+};
+
+// Streams bars from a CSV file without materializing the whole history
+class CsvBarSource : public BarSource {
+private:
+    std::string filename;
+    std::ifstream file;
+    std::string line;
+    int line_number;
+    
+    void open();
+    
+public:
+    explicit CsvBarSource(const std::string& filename);
+    
+    bool next_chunk(std::vector<MarketData>& out, size_t max_bars) override;
+    void reset() override;
+};
+
+// Serves bars from an in-memory vector (useful for tests and already-loaded data),
+// optionally restricted to the index range [first, last). Only a reference is
+// kept, so the vector must outlive the source; temporaries are rejected.
+class VectorBarSource : public BarSource {
+private:
+    const std::vector<MarketData>& data;
+    size_t first;
+    size_t last;
+    size_t cursor;
+    
+public:
+    explicit VectorBarSource(const std::vector<MarketData>& data) 
+        : data(data), first(0), last(data.size()), cursor(0) {}
+    VectorBarSource(const std::vector<MarketData>& data, size_t first, size_t last)
+        : data(data), first(std::min(first, data.size())), last(std::min(last, data.size())), cursor(this->first) {}
+    VectorBarSource(std::vector<MarketData>&&) = delete;
+    VectorBarSource(std::vector<MarketData>&&, size_t, size_t) = delete;
+    
+    bool next_chunk(std::vector<MarketData>& out, size_t max_bars) override;
+    void reset() override { cursor = first; }
+    bool is_resident() const override { return true; }
+};
+
+// Double-buffered reader: a background thread fills the next chunk while the
+// caller consumes the current one, so at most two chunks are resident at once
+class ChunkPrefetcher {
+private:
+    BarSource& source;
+    size_t chunk_size;
+    
+    std::vector<MarketData> back_buffer;
+    bool back_ready;
+    bool exhausted;
+    bool stopping;
+    std::exception_ptr error;
+    
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+    
+    void fill_loop();
+    
+public:
+    ChunkPrefetcher(BarSource& source, size_t chunk_size);
+    ~ChunkPrefetcher();
+    
+    ChunkPrefetcher(const ChunkPrefetcher&) = delete;
+    ChunkPrefetcher& operator=(const ChunkPrefetcher&) = delete;
+    
+    // Swap the next prefetched chunk into `chunk`; its old storage is recycled
+    // for the following prefetch. Returns false at end of stream.
+    bool next(std::vector<MarketData>& chunk);
+};
@@ -6,6 +6,7 @@
 #include <vector>
 #include <algorithm>
 #include <format>
+#include <stdexcept>
 
 // Performance-optimized string cleaning
 std::string clean_number(const std::string& str) {
@@ -20,6 +21,66 @@ std::string clean_number(const std::string& str) {
     return cleaned;
 }
 
+// Parse one CSV row into a MarketData record (shared by batch and streaming loaders)
+LoadStatus DataLoader::parse_csv_line(const std::string& line, int line_number, MarketData& row, std::string& error_message) {
+    try {
+        std::stringstream ss(line);
+        std::string item;
+        
+        // Parse each field with error handling
+        if (!std::getline(ss, row.date, ',')) {
+            error_message = std::format("Parse error at line {}", line_number);
+            return LoadStatus::ParseError;
+        }
+        
+        // Parse prices with validation
+        auto parse_price = [&](double& price, const std::string& /* field_name */) -> bool {
+            if (!std::getline(ss, item, ',')) return false;
+            try {
+                price = std::stod(clean_number(item));
+                return price > 0; // Validate positive price
+            } catch (...) {
+                return false;
+            }
+        };
+        
+        if (!parse_price(row.open, "open") || 
+            !parse_price(row.high, "high") || 
+            !parse_price(row.low, "low") || 
+            !parse_price(row.close, "close")) {
+            error_message = std::format("Invalid price data at line {}", line_number);
+            return LoadStatus::InvalidPriceData;
+        }
+        
+        // Parse volume
+        if (!std::getline(ss, item, ',')) {
+            error_message = std::format("Parse error at line {}", line_number);
+            return LoadStatus::ParseError;
+        }
+        try {
+            row.volume = std::stol(clean_number(item));
+            if (row.volume <= 0) {
+                error_message = std::format("Invalid volume at line {}", line_number);
+                return LoadStatus::InvalidPriceData;
+            }
+        } catch (...) {
+            error_message = std::format("Volume parse error at line {}", line_number);
+            return LoadStatus::ParseError;
+        }
+        
+        // Validate market data integrity
+        if (!row.is_valid()) {
+            error_message = std::format("Invalid OHLC data at line {}", line_number);
+            return LoadStatus::InvalidPriceData;
+        }
+    } catch (const std::exception& e) {
+        error_message = std::format("Exception at line {}: {}", line_number, e.what());
+        return LoadStatus::ParseError;
+    }
+    
+    return LoadStatus::Success;
+}
+
 // Enhanced error handling version with performance optimizations
 LoadResult DataLoader::loadCSV_safe(const std::string& filename) {
     LoadResult result;
@@ -49,72 +110,14 @@ LoadResult DataLoader::loadCSV_safe(const std::string& filename) {
     while (std::getline(file, line)) {
         line_number++;
         
-        try {
-            std::stringstream ss(line);
-            std::string item;
-            MarketData row;
-            
-            // Parse each field with error handling
-            if (!std::getline(ss, row.date, ',')) {
-                result.status = LoadStatus::ParseError;
-                result.error_message = std::format("Parse error at line {}", line_number);
-                return result;
-            }
-            
-            // Parse prices with validation
-            auto parse_price = [&](double& price, const std::string& /* field_name */) -> bool {
-                if (!std::getline(ss, item, ',')) return false;
-                try {
-                    price = std::stod(clean_number(item));
-                    return price > 0; // Validate positive price
-                } catch (...) {
-                    return false;
-                }
-            };
-            
-            if (!parse_price(row.open, "open") || 
-                !parse_price(row.high, "high") || 
-                !parse_price(row.low, "low") || 
-                !parse_price(row.close, "close")) {
-                result.status = LoadStatus::InvalidPriceData;
-                result.error_message = std::format("Invalid price data at line {}", line_number);
-                return result;
-            }
-            
-            // Parse volume
-            if (!std::getline(ss, item, ',')) {
-                result.status = LoadStatus::ParseError;
-                result.error_message = std::format("Parse error at line {}", line_number);
-                return result;
-            }
-            try {
-                row.volume = std::stol(clean_number(item));
-                if (row.volume <= 0) {
-                    result.status = LoadStatus::InvalidPriceData;
-                    result.error_message = std::format("Invalid volume at line {}", line_number);
-                    return result;
-                }
-            } catch (...) {
-                result.status = LoadStatus::ParseError;
-                result.error_message = std::format("Volume parse error at line {}", line_number);
-                return result;
-            }
-            
-            // Validate market data integrity
-            if (!row.is_valid()) {
-                result.status = LoadStatus::InvalidPriceData;
-                result.error_message = std::format("Invalid OHLC data at line {}", line_number);
-                return result;
-            }
-            
-            // Performance: Use move semantics
-            result.data.push_back(std::move(row));
-            
-        } catch (const std::exception& e) {
-            result.status = LoadStatus::ParseError;
-            result.error_message = std::format("Exception at line {}: {}", line_number, e.what());
+        MarketData row;
+        result.status = parse_csv_line(line, line_number, row, result.error_message);
+        if (!result.is_success()) {
             return result;
         }
+        
+        // Performance: Use move semantics
+        result.data.push_back(std::move(row));
     }
     
     if (result.data.empty()) {
@@ -126,7 +129,6 @@ LoadResult DataLoader::loadCSV_safe(const std::string& filename) {
     return result;
 }
 
-
 void DataLoader::print_summary(const std::vector<MarketData>& data) {
     if (data.empty()) {
         std::cout << "No data to summarize\n";
@@ -161,7 +163,7 @@ std::vector<MarketData> DataLoader::filter_by_date_range(
     std::vector<MarketData> filtered;
     
     for (const auto& day : data) {
-        if (day.date >= start_date && day.date <= end_date) {
+        if (in_date_range(day, start_date, end_date)) {
             filtered.push_back(day);
         }
     }
@@ -169,6 +171,39 @@ std::vector<MarketData> DataLoader::filter_by_date_range(
     return filtered;
 }
 
-
-
-
+int64_t DataLoader::date_key(const std::string& date) {
+    auto digits = [&](size_t pos, size_t count) {
+        int64_t value = 0;
+        for (size_t i = pos; i < pos + count; ++i) {
+            char c = date[i];
+            if (c < '0' || c > '9') {
+                throw std::invalid_argument(std::format("Unrecognized date: {}", date));
+            }
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    };
+    
+    int64_t day;
+    if (date.size() >= 10 && date[2] == '/' && date[5] == '/') {
+        day = digits(6, 4) * 10000 + digits(0, 2) * 100 + digits(3, 2);
+    } else if (date.size() >= 10 && date[4] == '-' && date[7] == '-') {
+        day = digits(0, 4) * 10000 + digits(5, 2) * 100 + digits(8, 2);
+    } else {
+        throw std::invalid_argument(std::format("Unrecognized date: {}", date));
+    }
+    
+    // Optional time of day: " hh:mm", " hh:mm:ss", or the same after a 'T'
+    int64_t time = 0;
+    if (date.size() > 10) {
+        bool separated = date[10] == ' ' || date[10] == 'T';
+        if (separated && date.size() == 16 && date[13] == ':') {
+            time = digits(11, 2) * 10000 + digits(14, 2) * 100;
+        } else if (separated && date.size() == 19 && date[13] == ':' && date[16] == ':') {
+            time = digits(11, 2) * 10000 + digits(14, 2) * 100 + digits(17, 2);
+        } else {
+            throw std::invalid_argument(std::format("Unrecognized date: {}", date));
+        }
+    }
+    return day * 1000000 + time;
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <concepts>
 #include <ranges>
+#include <cstdint>
 
 
 template<typename T>
@@ -74,6 +75,7 @@ class DataLoader {
 public:
     // Enhanced error handling 
     static LoadResult loadCSV_safe(const std::string& filename);
+    static LoadStatus parse_csv_line(const std::string& line, int line_number, MarketData& row, std::string& error_message);
     
     static void print_summary(const std::vector<MarketData>& data);
     static std::vector<MarketData> filter_by_date_range(
@@ -82,6 +84,17 @@ public:
         const std::string& end_date
     );
     
+    // "MM/DD/YYYY" (the CSV format) or "YYYY-MM-DD", optionally followed by a time of
+    // day (" hh:mm", " hh:mm:ss", or 'T' in place of the space), to YYYYMMDDhhmmss,
+    // which orders by calendar date and time; a bare date sorts at midnight. Throws
+    // std::invalid_argument on anything else. The value is a sort key, not a duration.
+    static int64_t date_key(const std::string& date);
+    
+    // Same predicate filter_by_date_range applies, usable on a single streamed bar
+    static bool in_date_range(const MarketData& day, const std::string& start_date, const std::string& end_date) {
+        return day.date >= start_date && day.date <= end_date;
+    }
+    
     template<Container T>
     static auto filter_valid_data(const T& data) {
         return data | std::views::filter([](const auto& day) { return day.is_valid(); });
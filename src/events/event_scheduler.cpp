@@ -0,0 +1,182 @@
+#include "event_scheduler.h"
+#include <algorithm>
+#include <array>
+#include <memory>
+
+namespace {
+
+constexpr size_t FRAME_GRANULE = 64;
+constexpr size_t FRAME_CLASSES = 32;        // Pooled frames up to 2 KB
+constexpr size_t BLOCKS_PER_SLAB = 64;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct ThreadFramePool {
+    std::array<FreeBlock*, FRAME_CLASSES> free_lists{};
+    std::vector<std::unique_ptr<std::byte[]>> slabs;
+    size_t live = 0;
+};
+
+thread_local ThreadFramePool frame_pool;
+
+size_t frame_class(size_t bytes) {
+    return (std::max<size_t>(bytes, 1) + FRAME_GRANULE - 1) / FRAME_GRANULE - 1;
+}
+
+}
+
+void* FramePool::allocate(size_t bytes) {
+    size_t cls = frame_class(bytes);
+    if (cls >= FRAME_CLASSES) return ::operator new(bytes);
+    
+    auto& pool = frame_pool;
+    if (!pool.free_lists[cls]) {
+        // Carve a fresh slab into blocks of this class
+        size_t block_size = (cls + 1) * FRAME_GRANULE;
+        pool.slabs.push_back(std::make_unique<std::byte[]>(block_size * BLOCKS_PER_SLAB));
+        std::byte* slab = pool.slabs.back().get();
+        for (size_t i = BLOCKS_PER_SLAB; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(slab + i * block_size);
+            block->next = pool.free_lists[cls];
+            pool.free_lists[cls] = block;
+        }
+    }
+    
+    FreeBlock* block = pool.free_lists[cls];
+    pool.free_lists[cls] = block->next;
+    pool.live++;
+    return block;
+}
+
+void FramePool::deallocate(void* ptr, size_t bytes) noexcept {
+    size_t cls = frame_class(bytes);
+    if (cls >= FRAME_CLASSES) {
+        ::operator delete(ptr);
+        return;
+    }
+    
+    auto& pool = frame_pool;
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = pool.free_lists[cls];
+    pool.free_lists[cls] = block;
+    pool.live--;
+}
+
+size_t FramePool::live_frames() {
+    return frame_pool.live;
+}
+
+namespace feeds {
+
+Feed replay(const std::vector<MarketData>& data) {
+    for (const auto& bar : data) {
+        co_yield bar;
+    }
+}
+
+Feed stream(BarSource& source, size_t chunk_size) {
+    std::vector<MarketData> chunk;
+    while (source.next_chunk(chunk, std::max<size_t>(chunk_size, 1))) {
+        for (const auto& bar : chunk) {
+            co_yield bar;
+        }
+    }
+}
+
+Feed resample(Feed source, size_t bars_per_frame) {
+    bars_per_frame = std::max<size_t>(bars_per_frame, 1);
+    MarketData frame{};
+    size_t count = 0;
+    
+    while (source.next()) {
+        const MarketData& bar = source.current();
+        if (count == 0) {
+            frame = bar;
+        } else {
+            frame.date = bar.date;
+            frame.high = std::max(frame.high, bar.high);
+            frame.low = std::min(frame.low, bar.low);
+            frame.close = bar.close;
+            frame.volume += bar.volume;
+        }
+        
+        if (++count == bars_per_frame) {
+            co_yield frame;
+            count = 0;
+        }
+    }
+    
+    if (count > 0) {
+        co_yield frame;
+    }
+}
+
+}
+
+EventScheduler::EventScheduler()
+    : current{0, 0, nullptr}, finished(false), events_dispatched(0) {}
+
+uint32_t EventScheduler::add_feed(std::string name, Feed feed) {
+    uint32_t id = static_cast<uint32_t>(feeds.size());
+    feeds.push_back(FeedState{std::move(name), std::move(feed)});
+    finished = false;
+    advance(id);
+    return id;
+}
+
+void EventScheduler::spawn(EventTask task) {
+    task.check();
+    tasks.push_back(std::move(task));
+}
+
+void EventScheduler::advance(uint32_t feed) {
+    Feed& source = feeds[feed].feed;
+    if (!source.next()) return;
+    
+    heap.push_back(Pending{DataLoader::date_key(source.current().date), feed});
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+// Hand the current event (or end of stream) to every waiting task. Tasks
+// re-register in `waiting` as they await again, hence the second buffer.
+// Every waiting task is resumed even if one throws, so none is dropped from
+// the wait list; the first exception is returned for the caller to rethrow.
+std::exception_ptr EventScheduler::dispatch() {
+    std::exception_ptr first_error;
+    resuming.swap(waiting);
+    for (auto handle : resuming) {
+        handle.resume();
+        if (!first_error && handle.promise().error) first_error = handle.promise().error;
+    }
+    resuming.clear();
+    return first_error;
+}
+
+size_t EventScheduler::run() {
+    size_t dispatched = 0;
+    while (!waiting.empty() && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Pending next = heap.back();
+        heap.pop_back();
+        
+        current = Event{next.feed, next.timestamp, &feeds[next.feed].feed.current()};
+        std::exception_ptr error = dispatch();
+        dispatched++;
+        
+        // Only now may the feed overwrite the bar the tasks were looking at
+        advance(next.feed);
+        if (error) {
+            events_dispatched += dispatched;
+            std::rethrow_exception(error);
+        }
+    }
+    
+    events_dispatched += dispatched;
+    if (heap.empty()) {
+        finished = true;
+        if (std::exception_ptr error = dispatch()) std::rethrow_exception(error);
+    }
+    return dispatched;
+}
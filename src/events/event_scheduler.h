@@ -0,0 +1,232 @@
+#pragma once
+#include "../data_loader.h"
+#include "../bar_source.h"
+#include "../backtester.h"
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Free-list allocator for coroutine frames. Feeds and tasks are created and
+// destroyed constantly when many feeds are merged, so frames are recycled by
+// size class instead of going through the global heap each time. Pools are
+// per thread: a frame must be destroyed on the thread that created it.
+class FramePool {
+public:
+    static void* allocate(size_t bytes);
+    static void deallocate(void* ptr, size_t bytes) noexcept;
+    
+    // Frames currently handed out by the calling thread's pool
+    static size_t live_frames();
+};
+
+// A data feed: a coroutine that yields bars in timestamp order. The yielded
+// bar is only valid until the feed is resumed again.
+class Feed {
+public:
+    struct promise_type {
+        const MarketData* current = nullptr;
+        std::exception_ptr error;
+        
+        Feed get_return_object() { return Feed(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const MarketData& bar) noexcept {
+            current = &bar;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+        
+        static void* operator new(size_t bytes) { return FramePool::allocate(bytes); }
+        static void operator delete(void* ptr, size_t bytes) noexcept { FramePool::deallocate(ptr, bytes); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+    
+    explicit Feed(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+public:
+    Feed(Feed&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Feed& operator=(Feed&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Feed(const Feed&) = delete;
+    Feed& operator=(const Feed&) = delete;
+    ~Feed() {
+        if (handle) handle.destroy();
+    }
+    
+    // Advance to the next bar; false once the feed is exhausted. Rethrows feed errors.
+    bool next() {
+        if (!handle || handle.done()) return false;
+        handle.resume();
+        if (handle.promise().error) std::rethrow_exception(std::exchange(handle.promise().error, {}));
+        return !handle.done();
+    }
+    
+    const MarketData& current() const { return *handle.promise().current; }
+};
+
+// Feed factories. Each expects its input in ascending date order.
+namespace feeds {
+
+// Bars of an already-loaded vector (which must outlive the feed)
+Feed replay(const std::vector<MarketData>& data);
+
+// Bars pulled chunk by chunk from a source (which must outlive the feed)
+Feed stream(BarSource& source, size_t chunk_size = 4096);
+
+// Coarser timeframe: every `bars_per_frame` bars of `source` merged into one
+// OHLCV bar stamped with the last bar's date. A trailing partial frame is emitted.
+Feed resample(Feed source, size_t bars_per_frame);
+
+// Signal source: only the bars of `source` for which `fires(bar)` is true.
+// `fires` may keep state (an indicator, say); it is called once per bar in order.
+template<typename Predicate>
+Feed filter(Feed source, Predicate fires) {
+    while (source.next()) {
+        if (fires(source.current())) co_yield source.current();
+    }
+}
+
+}
+
+// One bar from one feed, delivered in timestamp order across all feeds
+struct Event {
+    uint32_t feed;
+    int64_t timestamp;      // YYYYMMDDhhmmss, see DataLoader::date_key()
+    const MarketData* bar;  // Valid until the consumer awaits the next event
+};
+
+// A consumer of the merged event stream. Runs until its first co_await on
+// EventScheduler::next_event() when created, then whenever an event arrives.
+class EventTask {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+        
+        EventTask get_return_object() { return EventTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+        
+        static void* operator new(size_t bytes) { return FramePool::allocate(bytes); }
+        static void operator delete(void* ptr, size_t bytes) noexcept { FramePool::deallocate(ptr, bytes); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+    
+    explicit EventTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+public:
+    EventTask(EventTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    EventTask& operator=(EventTask&&) = delete;
+    EventTask(const EventTask&) = delete;
+    EventTask& operator=(const EventTask&) = delete;
+    ~EventTask() {
+        if (handle) handle.destroy();
+    }
+    
+    bool done() const { return !handle || handle.done(); }
+    
+    // Rethrows an exception that escaped the task body, if any
+    void check() const {
+        if (handle && handle.promise().error) std::rethrow_exception(handle.promise().error);
+    }
+};
+
+// Merges any number of feeds into one timestamp-ordered event stream on a
+// single thread. A binary heap holds the next bar of every live feed; each
+// popped event is handed to every task waiting in next_event(), then its feed
+// is advanced. Bars are ordered to the second when their dates carry a time
+// of day (a bare date sorts at midnight); ties go to the feed added first.
+// A date DataLoader::date_key() cannot parse throws std::invalid_argument from
+// add_feed() or run().
+class EventScheduler {
+private:
+    struct Pending {
+        int64_t timestamp;
+        uint32_t feed;
+    };
+    
+    struct FeedState {
+        std::string name;
+        Feed feed;
+    };
+    
+    std::vector<FeedState> feeds;
+    std::vector<Pending> heap;
+    std::vector<EventTask> tasks;
+    std::vector<std::coroutine_handle<EventTask::promise_type>> waiting;
+    std::vector<std::coroutine_handle<EventTask::promise_type>> resuming;
+    Event current;
+    bool finished;
+    size_t events_dispatched;
+    
+    // Heap order for the merge: earliest timestamp on top, then lowest feed id
+    static bool later(const Pending& a, const Pending& b) {
+        if (a.timestamp != b.timestamp) return a.timestamp > b.timestamp;
+        return a.feed > b.feed;
+    }
+    
+    void advance(uint32_t feed);
+    std::exception_ptr dispatch();
+
+public:
+    EventScheduler();
+    
+    EventScheduler(const EventScheduler&) = delete;
+    EventScheduler& operator=(const EventScheduler&) = delete;
+    
+    // Register a feed; returns its id (ids are assigned 0, 1, 2, ...)
+    uint32_t add_feed(std::string name, Feed feed);
+    const std::string& feed_name(uint32_t feed) const { return feeds.at(feed).name; }
+    size_t feed_count() const { return feeds.size(); }
+    
+    // Take ownership of a consumer; it has already run up to its first await
+    void spawn(EventTask task);
+    
+    // Awaitable (from an EventTask) yielding the next event, or nullptr once every feed is exhausted
+    auto next_event() {
+        struct Awaiter {
+            EventScheduler& scheduler;
+            
+            bool await_ready() const noexcept { return scheduler.finished; }
+            void await_suspend(std::coroutine_handle<EventTask::promise_type> handle) {
+                scheduler.waiting.push_back(handle);
+            }
+            const Event* await_resume() const noexcept {
+                return scheduler.finished ? nullptr : &scheduler.current;
+            }
+        };
+        return Awaiter{*this};
+    }
+    
+    // Dispatch events until the feeds run dry or no task is waiting any more.
+    // Rethrows the first exception raised by a feed or a task.
+    size_t run();
+    
+    size_t get_events_dispatched() const { return events_dispatched; }
+};
+
+// Run a bar-by-bar strategy on one feed of the merged stream, marking
+// `portfolio` to market on that feed's closes (like Backtester's loop)
+template<TradingStrategy T>
+EventTask drive(EventScheduler& scheduler, uint32_t feed, T& strategy, Portfolio& portfolio) {
+    while (const Event* event = co_await scheduler.next_event()) {
+        if (event->feed != feed) continue;
+        strategy.on_bar(*event->bar, portfolio);
+        portfolio.update_value(event->bar->close);
+    }
+}
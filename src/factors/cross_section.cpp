@@ -0,0 +1,366 @@
+#include "cross_section.h"
+#include "parallel_blocks.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <format>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+
+constexpr double MISSING = std::numeric_limits<double>::quiet_NaN();
+constexpr size_t MIN_SYMBOLS_PER_BLOCK = 256;
+constexpr size_t RESYNC_BARS = 1024;    // Rolling sums are rebuilt this often to shed rounding drift
+
+using Clock = std::chrono::high_resolution_clock;
+
+long long micros_since(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+}
+
+// Rebalancer implementation
+
+Rebalancer::Rebalancer(size_t num_symbols, double initial_cash, double cost_bps)
+    : shares(num_symbols, 0), last_price(num_symbols, MISSING), target_shares(num_symbols, 0),
+      is_held(num_symbols, 0), cash(initial_cash), equity(initial_cash), cost_rate(cost_bps / 10000.0),
+      total_costs(0.0), traded_value(0.0) {}
+
+double Rebalancer::mark(std::span<const double> closes) {
+    if (closes.size() != shares.size()) {
+        throw std::invalid_argument("Rebalancer::mark price count does not match symbol count");
+    }
+    
+    for (size_t s = 0; s < closes.size(); ++s) {
+        if (!std::isnan(closes[s])) last_price[s] = closes[s];
+    }
+    
+    equity = cash;
+    for (uint32_t s : held) {
+        equity += shares[s] * last_price[s];
+    }
+    return equity;
+}
+
+void Rebalancer::trade(uint32_t symbol, long target) {
+    long delta = target - shares[symbol];
+    if (delta == 0) return;
+    
+    double price = last_price[symbol];
+    double value = delta * price;
+    double cost = std::abs(value) * cost_rate;
+    cash -= value + cost;
+    total_costs += cost;
+    traded_value += std::abs(value);
+    shares[symbol] = target;
+    orders.push_back({symbol, delta, price});
+    
+    if (target != 0 && !is_held[symbol]) {
+        is_held[symbol] = 1;
+        held.push_back(symbol);
+    }
+}
+
+const std::vector<RebalanceOrder>& Rebalancer::rebalance(std::span<const TargetWeight> targets) {
+    orders.clear();
+    
+    // Size every target off the same pre-trade equity
+    for (const auto& target : targets) {
+        double price = last_price[target.symbol];
+        if (!(price > 0.0)) continue;   // Never quoted
+        target_shares[target.symbol] = static_cast<long>(std::trunc(target.weight * equity / price));
+    }
+    
+    // Held symbols first (anything not targeted has a target of zero), then new names
+    size_t previously_held = held.size();
+    for (size_t i = 0; i < previously_held; ++i) {
+        trade(held[i], target_shares[held[i]]);
+    }
+    for (const auto& target : targets) {
+        trade(target.symbol, target_shares[target.symbol]);
+        target_shares[target.symbol] = 0;
+    }
+    
+    std::erase_if(held, [this](uint32_t s) {
+        if (shares[s] != 0) return false;
+        is_held[s] = 0;
+        return true;
+    });
+    
+    equity = cash;
+    for (uint32_t s : held) {
+        equity += shares[s] * last_price[s];
+    }
+    return orders;
+}
+
+// CrossSectionalEngine implementation
+
+CrossSectionalEngine::CrossSectionalEngine(const PanelData& panel, const CrossSectionConfig& config)
+    : panel(panel), config(config), num_symbols(panel.num_symbols()) {
+    
+    if (config.factors.empty()) {
+        throw std::invalid_argument("CrossSectionalEngine needs at least one factor");
+    }
+    for (const auto& factor : config.factors) {
+        if (factor.lookback == 0 || (factor.kind == FactorKind::Momentum && factor.skip >= factor.lookback)) {
+            throw std::invalid_argument("Factor lookback must be positive and longer than its skip");
+        }
+    }
+    if (config.long_fraction < 0.0 || config.short_fraction < 0.0 ||
+        config.long_fraction + config.short_fraction > 1.0) {
+        throw std::invalid_argument("Long and short fractions must be non-negative and sum to at most 1");
+    }
+    
+    this->config.rebalance_interval = std::max<size_t>(config.rebalance_interval, 1);
+    this->config.tile_bars = std::max<size_t>(config.tile_bars, 1);
+    
+    factor_values.assign(config.factors.size() * this->config.tile_bars * num_symbols, MISSING);
+    rolling.resize(config.factors.size());
+    for (size_t f = 0; f < config.factors.size(); ++f) {
+        if (config.factors[f].kind == FactorKind::Reversal) {
+            rolling[f].assign(num_symbols, RollingStats{0.0, 0.0, 0});
+        }
+    }
+    tile_targets.resize(this->config.tile_bars);
+}
+
+bool CrossSectionalEngine::is_rebalance_bar(size_t bar) const {
+    return bar % config.rebalance_interval == 0;
+}
+
+// Factor values for bars [first_bar, first_bar + bars) of symbols [symbol_begin, symbol_end).
+// Bars must be visited in order: Reversal keeps running window sums per symbol.
+void CrossSectionalEngine::compute_factors(size_t first_bar, size_t bars, size_t symbol_begin, size_t symbol_end) {
+    const size_t n = num_symbols;
+    
+    for (size_t f = 0; f < config.factors.size(); ++f) {
+        const FactorSpec& factor = config.factors[f];
+        const size_t lookback = factor.lookback;
+        
+        for (size_t t = 0; t < bars; ++t) {
+            size_t bar = first_bar + t;
+            double* out = factor_values.data() + (f * config.tile_bars + t) * n;
+            const double* now = panel.row(bar).data();
+            
+            if (factor.kind == FactorKind::Momentum) {
+                if (bar < lookback) {
+                    std::fill(out + symbol_begin, out + symbol_end, MISSING);
+                    continue;
+                }
+                const double* recent = panel.row(bar - factor.skip).data();
+                const double* past = panel.row(bar - lookback).data();
+                for (size_t s = symbol_begin; s < symbol_end; ++s) {
+                    out[s] = recent[s] / past[s] - 1.0;
+                }
+                continue;
+            }
+            
+            // Reversal: slide the window, rebuilding the sums periodically
+            RollingStats* stats = rolling[f].data();
+            const double* dropped = bar >= lookback ? panel.row(bar - lookback).data() : nullptr;
+            bool resync = bar % RESYNC_BARS == 0 && bar + 1 >= lookback;
+            
+            for (size_t s = symbol_begin; s < symbol_end; ++s) {
+                RollingStats& window = stats[s];
+                if (resync) {
+                    window = RollingStats{0.0, 0.0, 0};
+                    for (size_t b = bar + 1 - lookback; b <= bar; ++b) {
+                        double close = panel.close(b, s);
+                        if (std::isnan(close)) {
+                            window.missing++;
+                        } else {
+                            window.sum += close;
+                            window.sum_squares += close * close;
+                        }
+                    }
+                } else {
+                    if (std::isnan(now[s])) {
+                        window.missing++;
+                    } else {
+                        window.sum += now[s];
+                        window.sum_squares += now[s] * now[s];
+                    }
+                    if (dropped) {
+                        if (std::isnan(dropped[s])) {
+                            window.missing--;
+                        } else {
+                            window.sum -= dropped[s];
+                            window.sum_squares -= dropped[s] * dropped[s];
+                        }
+                    }
+                }
+                
+                if (bar + 1 < lookback || window.missing > 0) {
+                    out[s] = MISSING;
+                    continue;
+                }
+                double mean = window.sum / lookback;
+                double variance = window.sum_squares / lookback - mean * mean;
+                out[s] = variance > 0.0 ? -(now[s] - mean) / std::sqrt(variance) : MISSING;
+            }
+        }
+    }
+}
+
+// Score one bar and pick its long and short baskets into tile_targets
+void CrossSectionalEngine::rank_bar(size_t tile_bar, std::vector<double>& scores, std::vector<RankedSymbol>& ranks) {
+    const size_t n = num_symbols;
+    const size_t factor_count = config.factors.size();
+    std::vector<TargetWeight>& targets = tile_targets[tile_bar];
+    targets.clear();
+    
+    scores.assign(n, 0.0);
+    for (size_t f = 0; f < factor_count; ++f) {
+        const double* values = factor_values.data() + (f * config.tile_bars + tile_bar) * n;
+        double weight = config.factors[f].weight;
+        
+        if (factor_count == 1) {
+            for (size_t s = 0; s < n; ++s) scores[s] = weight * values[s];
+            break;
+        }
+        
+        // Standardize across the symbols that have a value
+        double sum = 0.0, sum_squares = 0.0;
+        size_t count = 0;
+        for (size_t s = 0; s < n; ++s) {
+            if (std::isnan(values[s])) continue;
+            sum += values[s];
+            sum_squares += values[s] * values[s];
+            count++;
+        }
+        double mean = count > 0 ? sum / count : 0.0;
+        double variance = count > 0 ? sum_squares / count - mean * mean : 0.0;
+        double scale = variance > 0.0 ? weight / std::sqrt(variance) : 0.0;
+        for (size_t s = 0; s < n; ++s) {
+            scores[s] += (values[s] - mean) * scale;    // NaN stays NaN
+        }
+    }
+    
+    ranks.clear();
+    for (size_t s = 0; s < n; ++s) {
+        if (std::isfinite(scores[s])) ranks.push_back({scores[s], static_cast<uint32_t>(s)});
+    }
+    
+    size_t ranked = ranks.size();
+    size_t long_count = static_cast<size_t>(ranked * config.long_fraction);
+    size_t short_count = static_cast<size_t>(ranked * config.short_fraction);
+    if (config.gross_long == 0.0) long_count = 0;
+    if (config.gross_short == 0.0) short_count = 0;
+    
+    // Best first; ties broken by symbol so results don't depend on the partition
+    auto better = [](const RankedSymbol& a, const RankedSymbol& b) {
+        return a.score > b.score || (a.score == b.score && a.symbol < b.symbol);
+    };
+    if (long_count > 0 && long_count < ranked) {
+        std::nth_element(ranks.begin(), ranks.begin() + long_count, ranks.end(), better);
+    }
+    if (short_count > 0 && long_count + short_count < ranked) {
+        std::nth_element(ranks.begin() + long_count, ranks.end() - short_count, ranks.end(), better);
+    }
+    
+    for (size_t i = 0; i < long_count; ++i) {
+        targets.push_back({ranks[i].symbol, config.gross_long / long_count});
+    }
+    for (size_t i = ranked - short_count; i < ranked; ++i) {
+        targets.push_back({ranks[i].symbol, -config.gross_short / short_count});
+    }
+}
+
+CrossSectionResult CrossSectionalEngine::run() {
+    auto start_time = Clock::now();
+    CrossSectionResult result{};
+    
+    const size_t total_bars = panel.num_bars();
+    const size_t symbol_blocks = block_count(num_symbols, MIN_SYMBOLS_PER_BLOCK, config.threads);
+    
+    Rebalancer rebalancer(num_symbols, config.initial_cash, config.cost_bps);
+    result.equity_curve.reserve(total_bars);
+    
+    std::vector<size_t> rebalance_bars;
+    rebalance_bars.reserve(config.tile_bars);
+    double turnover_sum = 0.0;
+    double positions_sum = 0.0;
+    
+    for (size_t first_bar = 0; first_bar < total_bars; first_bar += config.tile_bars) {
+        size_t bars = std::min(config.tile_bars, total_bars - first_bar);
+        
+        // 1. Factors for the whole tile, split by symbol block
+        auto stage_start = Clock::now();
+        parallel_blocks(num_symbols, symbol_blocks, [&](size_t, size_t begin, size_t end) {
+            compute_factors(first_bar, bars, begin, end);
+        });
+        result.factor_micros += micros_since(stage_start);
+        
+        // 2. Rank the tile's rebalance bars, split by bar block
+        stage_start = Clock::now();
+        rebalance_bars.clear();
+        for (size_t t = 0; t < bars; ++t) {
+            if (is_rebalance_bar(first_bar + t)) rebalance_bars.push_back(t);
+        }
+        size_t rank_blocks = block_count(rebalance_bars.size(), 1, config.threads);
+        block_scores.resize(std::max(block_scores.size(), rank_blocks));
+        block_ranks.resize(std::max(block_ranks.size(), rank_blocks));
+        parallel_blocks(rebalance_bars.size(), rank_blocks, [&](size_t block, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                rank_bar(rebalance_bars[i], block_scores[block], block_ranks[block]);
+            }
+        });
+        result.rank_micros += micros_since(stage_start);
+        if (tile_hook) tile_hook(first_bar, bars);
+        
+        // 3. Mark and trade bar by bar; bars with nothing ranked (warmup) keep the current book
+        stage_start = Clock::now();
+        for (size_t t = 0; t < bars; ++t) {
+            size_t bar = first_bar + t;
+            double equity = rebalancer.mark(panel.row(bar));
+            
+            if (is_rebalance_bar(bar) && !tile_targets[t].empty()) {
+                double traded_before = rebalancer.get_traded_value();
+                const auto& orders = rebalancer.rebalance(tile_targets[t]);
+                result.rebalances++;
+                result.orders += orders.size();
+                turnover_sum += (rebalancer.get_traded_value() - traded_before) / equity;
+                positions_sum += rebalancer.get_positions();
+            }
+            result.equity_curve.push_back(rebalancer.get_equity());
+        }
+        result.rebalance_micros += micros_since(stage_start);
+    }
+    
+    // Performance metrics from the equity curve
+    const auto& curve = result.equity_curve;
+    if (!curve.empty()) {
+        double final_equity = curve.back();
+        result.total_return = (final_equity - config.initial_cash) / config.initial_cash * 100.0;
+        double growth = final_equity / config.initial_cash;
+        result.annualized_return = growth > 0.0
+            ? (std::pow(growth, 252.0 / curve.size()) - 1.0) * 100.0
+            : -100.0;
+        
+        double peak = config.initial_cash;
+        double sum = 0.0, sum_squares = 0.0;
+        double previous = config.initial_cash;
+        for (double equity : curve) {
+            peak = std::max(peak, equity);
+            result.max_drawdown = std::max(result.max_drawdown, (peak - equity) / peak * 100.0);
+            double period_return = equity / previous - 1.0;
+            sum += period_return;
+            sum_squares += period_return * period_return;
+            previous = equity;
+        }
+        double mean = sum / curve.size();
+        double variance = sum_squares / curve.size() - mean * mean;
+        result.sharpe_ratio = variance > 0.0 ? mean / std::sqrt(variance) * std::sqrt(252.0) : 0.0;
+    }
+    
+    result.total_costs = rebalancer.get_total_costs();
+    if (result.rebalances > 0) {
+        result.avg_turnover = turnover_sum / result.rebalances;
+        result.avg_positions = positions_sum / result.rebalances;
+    }
+    result.total_micros = micros_since(start_time);
+    return result;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include "panel_data.h"
+#include <vector>
+#include <span>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+enum class FactorKind : uint32_t {
+    Momentum,   // close[t - skip] / close[t - lookback] - 1
+    Reversal    // Negated z-score of the close against its `lookback`-bar mean
+};
+
+// One factor of the ranking score. Higher values rank better; a negative
+// weight flips a factor. With several factors, each is standardized across
+// the universe per bar before the weighted sum.
+struct FactorSpec {
+    FactorKind kind;
+    size_t lookback;
+    size_t skip = 0;        // Momentum: most recent bars left out of the return
+    double weight = 1.0;
+};
+
+struct CrossSectionConfig {
+    std::vector<FactorSpec> factors;
+    double long_fraction = 0.1;         // Top decile held long...
+    double short_fraction = 0.1;        // ...bottom decile short (0 for long-only)
+    double gross_long = 1.0;            // Long book as a fraction of equity, equal-weighted
+    double gross_short = 1.0;
+    size_t rebalance_interval = 1;      // Bars between rebalances
+    double initial_cash = 10000000.0;
+    double cost_bps = 1.0;              // Transaction cost on traded value
+    size_t threads = 0;                 // 0 = hardware concurrency
+    size_t tile_bars = 128;             // Bars scored per pass; bounds the factor buffers
+};
+
+struct TargetWeight {
+    uint32_t symbol;
+    double weight;          // Fraction of equity; negative for shorts
+};
+
+struct RebalanceOrder {
+    uint32_t symbol;
+    long quantity;          // Signed shares
+    double price;
+};
+
+// Turns target weights into whole-share orders against a multi-symbol book.
+// Symbols without a current close are valued, and traded, at their last close.
+class Rebalancer {
+private:
+    std::vector<long> shares;
+    std::vector<double> last_price;
+    std::vector<long> target_shares;
+    std::vector<uint8_t> is_held;
+    std::vector<uint32_t> held;         // Symbols with non-zero shares
+    std::vector<RebalanceOrder> orders;
+    double cash;
+    double equity;
+    double cost_rate;
+    double total_costs;
+    double traded_value;
+    
+    void trade(uint32_t symbol, long target);
+
+public:
+    Rebalancer(size_t num_symbols, double initial_cash, double cost_bps);
+    
+    // Take one bar of closes (NaN = no quote) and return the book's value
+    double mark(std::span<const double> closes);
+    
+    // Trade to `targets` at the last marked prices; symbols not listed go flat
+    const std::vector<RebalanceOrder>& rebalance(std::span<const TargetWeight> targets);
+    
+    double get_equity() const { return equity; }
+    double get_cash() const { return cash; }
+    double get_total_costs() const { return total_costs; }
+    double get_traded_value() const { return traded_value; }
+    size_t get_positions() const { return held.size(); }
+    long get_shares(size_t symbol) const { return shares[symbol]; }
+};
+
+struct CrossSectionResult {
+    double total_return;
+    double annualized_return;
+    double sharpe_ratio;            // Annualized, 252 bars per year
+    double max_drawdown;
+    double avg_turnover;            // Traded value / equity per rebalance
+    double total_costs;
+    size_t rebalances;
+    size_t orders;
+    double avg_positions;           // Per rebalance
+    std::vector<double> equity_curve;
+    
+    // Wall time per stage
+    long long factor_micros;
+    long long rank_micros;
+    long long rebalance_micros;
+    long long total_micros;
+};
+
+// Called once per tile after ranking and before trading, with the tile's
+// bars [first_bar, first_bar + bars); the engine's factor_value() and
+// targets() read that tile until the hook returns
+using TileHook = std::function<void(size_t first_bar, size_t bars)>;
+
+// Cross-sectional factor backtest over a panel.
+//
+// The panel is processed in tiles of `tile_bars` bars. For each tile the
+// factor values of every symbol are computed in parallel by symbol block
+// (each block owns its symbols' rolling state), then every rebalance bar of
+// the tile is ranked in parallel by bar block: composite scores, then
+// nth_element to pull out the long and short baskets. A single thread then
+// walks the tile's bars through the Rebalancer.
+class CrossSectionalEngine {
+private:
+    struct RankedSymbol {
+        double score;
+        uint32_t symbol;
+    };
+    
+    // Rolling sums for a Reversal factor, per symbol
+    struct RollingStats {
+        double sum;
+        double sum_squares;
+        size_t missing;         // NaN closes in the window
+    };
+    
+    const PanelData& panel;
+    CrossSectionConfig config;
+    size_t num_symbols;
+    
+    // factor x tile bar x symbol, reused across tiles
+    std::vector<double> factor_values;
+    std::vector<std::vector<RollingStats>> rolling;    // Per factor (empty for Momentum)
+    
+    // Targets for each bar of the tile, and per-block ranking scratch
+    std::vector<std::vector<TargetWeight>> tile_targets;
+    std::vector<std::vector<double>> block_scores;
+    std::vector<std::vector<RankedSymbol>> block_ranks;
+    TileHook tile_hook;
+    
+    void compute_factors(size_t first_bar, size_t bars, size_t symbol_begin, size_t symbol_end);
+    void rank_bar(size_t tile_bar, std::vector<double>& scores, std::vector<RankedSymbol>& ranks);
+    bool is_rebalance_bar(size_t bar) const;
+
+public:
+    // Throws std::invalid_argument for an empty factor list or invalid fractions
+    CrossSectionalEngine(const PanelData& panel, const CrossSectionConfig& config);
+    
+    CrossSectionResult run();
+    
+    // Inspection of the current tile, for checks run from a tile hook
+    void set_tile_hook(TileHook hook) { tile_hook = std::move(hook); }
+    double factor_value(size_t factor, size_t tile_bar, size_t symbol) const {
+        return factor_values[(factor * config.tile_bars + tile_bar) * num_symbols + symbol];
+    }
+    // Baskets picked at a rebalance bar of the tile (empty during warmup), in no particular order
+    std::span<const TargetWeight> targets(size_t tile_bar) const { return tile_targets[tile_bar]; }
+};
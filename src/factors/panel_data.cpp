@@ -0,0 +1,153 @@
+#include "panel_data.h"
+#include "parallel_blocks.h"
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <format>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+
+constexpr double MISSING = std::numeric_limits<double>::quiet_NaN();
+constexpr size_t MIN_SYMBOLS_PER_BLOCK = 64;
+constexpr size_t SYMBOLS_PER_GROUP = 64;
+
+// Weekday dates from 01/02/2004 in the MM/DD/YYYY form the CSVs use
+std::vector<std::string> business_days(size_t count) {
+    static constexpr int DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    std::vector<std::string> dates;
+    dates.reserve(count);
+    
+    int year = 2004, month = 1, day = 2;
+    int weekday = 5;    // 01/02/2004 was a Friday (Monday = 1)
+    while (dates.size() < count) {
+        if (weekday <= 5) {
+            dates.push_back(std::format("{:02}/{:02}/{}", month, day, year));
+        }
+        
+        weekday = weekday % 7 + 1;
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        int month_days = DAYS_IN_MONTH[month - 1] + (month == 2 && leap ? 1 : 0);
+        if (++day > month_days) {
+            day = 1;
+            if (++month > 12) {
+                month = 1;
+                year++;
+            }
+        }
+    }
+    return dates;
+}
+
+}
+
+PanelData::PanelData(std::vector<std::string> symbols, std::vector<std::string> dates, std::vector<double> closes)
+    : symbols(std::move(symbols)), dates(std::move(dates)), closes(std::move(closes)) {
+    if (this->closes.size() != this->symbols.size() * this->dates.size()) {
+        throw std::invalid_argument(std::format("Panel has {} closes for {} bars x {} symbols",
+            this->closes.size(), this->dates.size(), this->symbols.size()));
+    }
+}
+
+PanelData PanelData::align(const std::vector<std::string>& symbols,
+                           const std::vector<std::vector<MarketData>>& histories) {
+    if (symbols.size() != histories.size()) {
+        throw std::invalid_argument("PanelData::align needs one history per symbol");
+    }
+    
+    // Union of all dates, ordered by calendar date rather than string
+    std::vector<std::pair<int64_t, std::string>> all_dates;
+    for (const auto& history : histories) {
+        for (const auto& bar : history) {
+            all_dates.emplace_back(DataLoader::date_key(bar.date), bar.date);
+        }
+    }
+    std::sort(all_dates.begin(), all_dates.end());
+    all_dates.erase(std::unique(all_dates.begin(), all_dates.end(),
+        [](const auto& a, const auto& b) { return a.first == b.first; }), all_dates.end());
+    
+    std::vector<std::string> dates;
+    std::vector<int64_t> stamps;
+    dates.reserve(all_dates.size());
+    stamps.reserve(all_dates.size());
+    for (auto& [stamp, date] : all_dates) {
+        stamps.push_back(stamp);
+        dates.push_back(std::move(date));
+    }
+    
+    const size_t n = symbols.size();
+    std::vector<double> closes(dates.size() * n, MISSING);
+    for (size_t s = 0; s < n; ++s) {
+        for (const auto& row : histories[s]) {
+            int64_t stamp = DataLoader::date_key(row.date);
+            size_t bar = std::lower_bound(stamps.begin(), stamps.end(), stamp) - stamps.begin();
+            closes[bar * n + s] = row.close;
+        }
+    }
+    
+    return PanelData(symbols, std::move(dates), std::move(closes));
+}
+
+PanelData PanelData::synthetic(size_t num_symbols, size_t num_bars, uint32_t seed, size_t threads) {
+    std::vector<std::string> symbols;
+    symbols.reserve(num_symbols);
+    for (size_t s = 0; s < num_symbols; ++s) {
+        symbols.push_back(std::format("SYM{:04}", s));
+    }
+    
+    std::vector<double> closes(num_bars * num_symbols, MISSING);
+    
+    // Each symbol has its own generator, so blocks can fill their columns independently.
+    // Symbols are stepped a group at a time, bar by bar, so writes stay within a few rows.
+    struct SymbolState {
+        std::mt19937_64 rng;
+        std::normal_distribution<double> normal;   // Caches a spare draw, so one per symbol
+        double volatility;
+        double drift;
+        size_t first;       // Listing bar
+        size_t last;        // One past the delisting bar
+        double log_price;
+        double trend;
+    };
+    
+    size_t blocks = block_count(num_symbols, MIN_SYMBOLS_PER_BLOCK, threads);
+    parallel_blocks(num_symbols, blocks, [&](size_t, size_t begin, size_t end) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<SymbolState> group;
+        
+        for (size_t group_begin = begin; group_begin < end; group_begin += SYMBOLS_PER_GROUP) {
+            size_t group_end = std::min(end, group_begin + SYMBOLS_PER_GROUP);
+            group.clear();
+            for (size_t s = group_begin; s < group_end; ++s) {
+                std::mt19937_64 rng(static_cast<uint64_t>(seed) << 32 ^ s);
+                std::normal_distribution<double> normal(0.0, 1.0);
+                double volatility = 0.01 + 0.02 * uniform(rng);
+                double drift = 0.0002 + 0.0003 * normal(rng);
+                
+                // Most symbols trade throughout; some list late and some delist early
+                size_t first = uniform(rng) < 0.7 ? 0 : static_cast<size_t>(uniform(rng) * num_bars / 2);
+                size_t last = uniform(rng) < 0.9 ? num_bars : num_bars / 2 + static_cast<size_t>(uniform(rng) * num_bars / 2);
+                double log_price = std::log(10.0 + 190.0 * uniform(rng));
+                SymbolState state{std::move(rng), std::move(normal), volatility, drift, first, last, log_price, 0.0};
+                group.push_back(std::move(state));
+            }
+            
+            // Random walk around a slow-moving trend, which is what momentum can pick up
+            for (size_t bar = 0; bar < num_bars; ++bar) {
+                double* row = closes.data() + bar * num_symbols;
+                for (size_t i = 0; i < group.size(); ++i) {
+                    SymbolState& state = group[i];
+                    if (bar < state.first || bar >= state.last) continue;
+                    
+                    double shock = state.volatility * state.normal(state.rng);
+                    state.trend = 0.995 * state.trend + 0.00002 * state.normal(state.rng);
+                    state.log_price += state.drift + state.trend + shock;
+                    row[group_begin + i] = std::exp(state.log_price);
+                }
+            }
+        }
+    });
+    
+    return PanelData(std::move(symbols), business_days(num_bars), std::move(closes));
+}
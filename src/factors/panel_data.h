@@ -0,0 +1,44 @@
+#pragma once
+#include "../data_loader.h"
+#include <vector>
+#include <string>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+// Closes for a universe of symbols on a shared date axis, stored bar-major:
+// row `bar` holds one close per symbol, so a cross-section is one contiguous
+// span. Missing closes (before listing, after delisting, gaps) are NaN.
+class PanelData {
+private:
+    std::vector<std::string> symbols;
+    std::vector<std::string> dates;
+    std::vector<double> closes;     // num_bars x num_symbols
+
+public:
+    PanelData() = default;
+    
+    // Throws std::invalid_argument if `closes` is not dates.size() x symbols.size()
+    PanelData(std::vector<std::string> symbols, std::vector<std::string> dates, std::vector<double> closes);
+    
+    // Align per-symbol histories (in any order) on the union of their dates
+    static PanelData align(const std::vector<std::string>& symbols,
+                           const std::vector<std::vector<MarketData>>& histories);
+    
+    // Random-walk universe for benchmarks: per-symbol drift and volatility, a
+    // slowly changing trend, and staggered listing and delisting dates. Deterministic for a
+    // given seed regardless of thread count.
+    static PanelData synthetic(size_t num_symbols, size_t num_bars, uint32_t seed = 42, size_t threads = 0);
+    
+    size_t num_symbols() const { return symbols.size(); }
+    size_t num_bars() const { return dates.size(); }
+    
+    std::span<const double> row(size_t bar) const {
+        return {closes.data() + bar * symbols.size(), symbols.size()};
+    }
+    double close(size_t bar, size_t symbol) const { return closes[bar * symbols.size() + symbol]; }
+    
+    const std::string& symbol(size_t index) const { return symbols[index]; }
+    const std::string& date(size_t bar) const { return dates[bar]; }
+    size_t price_bytes() const { return closes.size() * sizeof(double); }
+};
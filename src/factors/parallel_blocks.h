@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Number of blocks [0, count) is split into: one per thread, but none
+// smaller than `min_per_block` items
+inline size_t block_count(size_t count, size_t min_per_block, size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<size_t>(count / std::max<size_t>(min_per_block, 1), 1, threads);
+}
+
+// Split [0, count) into contiguous blocks and run fn(block, begin, end) on each,
+// one thread per block (inline when there is a single block)
+template<typename F>
+void parallel_blocks(size_t count, size_t blocks, F&& fn) {
+    if (blocks <= 1) {
+        fn(0, 0, count);
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    workers.reserve(blocks);
+    for (size_t block = 0; block < blocks; ++block) {
+        size_t begin = count * block / blocks;
+        size_t end = count * (block + 1) / blocks;
+        workers.emplace_back([&fn, block, begin, end] { fn(block, begin, end); });
+    }
+    for (auto& worker : workers) worker.join();
+}
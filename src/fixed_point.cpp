@@ -0,0 +1,108 @@
+#include "fixed_point.h"
+#include <algorithm>
+#include <limits>
+#include <format>
+#include <stdexcept>
+#include <cmath>
+
+TickSeries TickSeries::encode(const std::vector<MarketData>& data, TickScale scale) {
+    TickSeries series;
+    series.scale = scale;
+    series.base = 0;
+    series.wide = false;
+    if (data.empty()) return series;
+    
+    // llround is only defined while the tick count fits int64
+    constexpr double TICK_LIMIT = 0x1p63;
+    int64_t lowest = std::numeric_limits<int64_t>::max();
+    int64_t highest = std::numeric_limits<int64_t>::min();
+    for (const auto& bar : data) {
+        for (double price : {bar.open, bar.high, bar.low, bar.close}) {
+            if (!(std::abs(price * static_cast<double>(scale.ticks_per_unit)) < TICK_LIMIT)) {
+                throw std::range_error(std::format("Price {} on {} cannot be put on a tick grid of {} per unit",
+                    price, bar.date, scale.ticks_per_unit));
+            }
+            int64_t ticks = scale.to_ticks(price);
+            lowest = std::min(lowest, ticks);
+            highest = std::max(highest, ticks);
+        }
+    }
+    
+    // Compared as unsigned, since the range itself can exceed int64
+    uint64_t range = static_cast<uint64_t>(highest) - static_cast<uint64_t>(lowest);
+    series.wide = range > static_cast<uint64_t>(std::numeric_limits<int32_t>::max());
+    series.base = lowest;
+    
+    series.dates.reserve(data.size());
+    series.volume.reserve(data.size());
+    if (series.wide) {
+        series.prices.reserve(data.size());
+    } else {
+        series.offsets.reserve(data.size());
+    }
+    
+    auto offset = [&](double price) { return static_cast<int32_t>(scale.to_ticks(price) - lowest); };
+    auto snap = [&](double price) { return scale.to_price(scale.to_ticks(price)); };
+    for (const auto& bar : data) {
+        series.dates.push_back(bar.date);
+        if (series.wide) {
+            series.prices.open.push_back(snap(bar.open));
+            series.prices.high.push_back(snap(bar.high));
+            series.prices.low.push_back(snap(bar.low));
+            series.prices.close.push_back(snap(bar.close));
+        } else {
+            series.offsets.open.push_back(offset(bar.open));
+            series.offsets.high.push_back(offset(bar.high));
+            series.offsets.low.push_back(offset(bar.low));
+            series.offsets.close.push_back(offset(bar.close));
+        }
+        series.volume.push_back(bar.volume);
+    }
+    return series;
+}
+
+MarketData TickSeries::bar(size_t i) const {
+    if (wide) {
+        return MarketData{dates[i], prices.open[i], prices.high[i], prices.low[i], prices.close[i],
+                          static_cast<long>(volume[i])};
+    }
+    return MarketData{dates[i], scale.to_price(base + offsets.open[i]), scale.to_price(base + offsets.high[i]),
+                      scale.to_price(base + offsets.low[i]), scale.to_price(base + offsets.close[i]),
+                      static_cast<long>(volume[i])};
+}
+
+void TickSeries::decode(size_t first, size_t last, std::vector<MarketData>& out) const {
+    last = std::min(last, size());
+    first = std::min(first, last);
+    out.resize(last - first);
+    if (wide) {
+        for (size_t i = first; i < last; ++i) {
+            MarketData& bar = out[i - first];
+            bar.date = dates[i];
+            bar.open = prices.open[i];
+            bar.high = prices.high[i];
+            bar.low = prices.low[i];
+            bar.close = prices.close[i];
+            bar.volume = static_cast<long>(volume[i]);
+        }
+        return;
+    }
+    
+    for (size_t i = first; i < last; ++i) {
+        MarketData& bar = out[i - first];
+        bar.date = dates[i];
+        bar.open = scale.to_price(base + offsets.open[i]);
+        bar.high = scale.to_price(base + offsets.high[i]);
+        bar.low = scale.to_price(base + offsets.low[i]);
+        bar.close = scale.to_price(base + offsets.close[i]);
+        bar.volume = static_cast<long>(volume[i]);
+    }
+}
+
+bool TickBarSource::next_chunk(std::vector<MarketData>& out, size_t max_bars) {
+    if (cursor >= series.size()) return false;
+    size_t last = std::min(series.size(), cursor + std::max<size_t>(max_bars, 1));
+    series.decode(cursor, last, out);
+    cursor = last;
+    return true;
+}
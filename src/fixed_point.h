@@ -0,0 +1,90 @@
+#pragma once
+#include "data_loader.h"
+#include "bar_source.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+
+// Money in whole cents. Fixed-point accounting keeps cash, position value and
+// PnL in these, so results don't depend on the order floating-point sums run in.
+using Cents = int64_t;
+
+constexpr Cents CENTS_PER_DOLLAR = 100;
+
+inline Cents to_cents(double dollars) { return std::llround(dollars * CENTS_PER_DOLLAR); }
+inline double to_dollars(Cents cents) { return static_cast<double>(cents) / CENTS_PER_DOLLAR; }
+
+// Integer price grid: a price of p is stored as round(p * ticks_per_unit)
+struct TickScale {
+    int64_t ticks_per_unit = 10000;     // 0.0001 tick
+    
+    int64_t to_ticks(double price) const { return std::llround(price * static_cast<double>(ticks_per_unit)); }
+    double to_price(int64_t ticks) const { return static_cast<double>(ticks) / static_cast<double>(ticks_per_unit); }
+};
+
+// Compact price history: OHLC as int32 tick offsets from a per-series base,
+// half the size of the double columns in MarketData. Prices are snapped to
+// the tick grid on the way in, so decoded bars are exactly reproducible.
+// A series whose range is too wide for int32 offsets keeps the snapped
+// prices as doubles instead, which decodes to the same bars.
+class TickSeries {
+private:
+    template<typename T>
+    struct PriceColumns {
+        std::vector<T> open;
+        std::vector<T> high;
+        std::vector<T> low;
+        std::vector<T> close;
+        
+        void reserve(size_t bars) {
+            open.reserve(bars);
+            high.reserve(bars);
+            low.reserve(bars);
+            close.reserve(bars);
+        }
+    };
+    
+    TickScale scale;
+    int64_t base;       // Lowest low of the series, in ticks
+    bool wide;          // Prices are in `prices` rather than `offsets`
+    std::vector<std::string> dates;
+    PriceColumns<int32_t> offsets;
+    PriceColumns<double> prices;
+    std::vector<int64_t> volume;
+
+public:
+    // Throws std::range_error if a price is not finite or too large for int64 ticks
+    static TickSeries encode(const std::vector<MarketData>& data, TickScale scale = {});
+    
+    size_t size() const { return dates.size(); }
+    const TickScale& get_scale() const { return scale; }
+    int64_t get_base() const { return base; }
+    bool is_wide() const { return wide; }
+    
+    // Absolute tick prices
+    int64_t close_ticks(size_t i) const { return wide ? scale.to_ticks(prices.close[i]) : base + offsets.close[i]; }
+    
+    MarketData bar(size_t i) const;
+    void decode(size_t first, size_t last, std::vector<MarketData>& out) const;
+    
+    // Bytes held by the price columns, against the 4 doubles per bar they replace
+    size_t price_bytes() const { return 4 * size() * (wide ? sizeof(double) : sizeof(int32_t)); }
+    size_t double_price_bytes() const { return 4 * size() * sizeof(double); }
+};
+
+// Feeds a backtest from a tick series, decoding one chunk at a time. Only a
+// reference is kept, so the series must outlive the source; temporaries are rejected.
+class TickBarSource : public BarSource {
+private:
+    const TickSeries& series;
+    size_t cursor;
+
+public:
+    explicit TickBarSource(const TickSeries& series) : series(series), cursor(0) {}
+    TickBarSource(TickSeries&&) = delete;
+    
+    bool next_chunk(std::vector<MarketData>& out, size_t max_bars) override;
+    void reset() override { cursor = 0; }
+    bool is_resident() const override { return true; }
+};
@@ -0,0 +1,206 @@
+#include "indicator_cache.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <format>
+
+namespace {
+
+constexpr double NOT_READY = std::numeric_limits<double>::quiet_NaN();
+
+uint64_t bits_of(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// FNV-1a over the origin and the raw bits of the closes
+uint64_t fingerprint(const std::string& origin, const std::vector<double>& closes) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix_byte = [&hash](uint64_t byte) {
+        hash ^= byte & 0xff;
+        hash *= 0x100000001b3ULL;
+    };
+    auto mix = [&](uint64_t word) {
+        for (int i = 0; i < 8; ++i) mix_byte(word >> (i * 8));
+    };
+    
+    mix(origin.size());
+    for (char c : origin) mix_byte(static_cast<unsigned char>(c));
+    mix(closes.size());
+    for (double close : closes) mix(bits_of(close));
+    return hash;
+}
+
+void check_period(int period) {
+    if (period < 1) throw std::invalid_argument("Indicator period must be positive");
+}
+
+}
+
+PriceSeries PriceSeries::from_closes(std::vector<double> closes, std::string origin) {
+    uint64_t id = fingerprint(origin, closes);
+    return PriceSeries{id, std::move(origin), std::move(closes)};
+}
+
+PriceSeries PriceSeries::from_market_data(const std::vector<MarketData>& data) {
+    std::vector<double> closes;
+    closes.reserve(data.size());
+    for (const auto& bar : data) {
+        closes.push_back(bar.close);
+    }
+    return from_closes(std::move(closes), data.empty() ? std::string() : data.front().date);
+}
+
+namespace indicators {
+
+std::vector<double> ema(const std::vector<double>& closes, int period) {
+    check_period(period);
+    std::vector<double> column(closes.size());
+    if (closes.empty()) return column;
+    
+    double alpha = 2.0 / (period + 1.0);
+    column[0] = closes[0];
+    for (size_t i = 1; i < closes.size(); ++i) {
+        column[i] = alpha * closes[i] + (1.0 - alpha) * column[i - 1];
+    }
+    return column;
+}
+
+std::vector<double> sma(const std::vector<double>& closes, int period) {
+    check_period(period);
+    size_t window = static_cast<size_t>(period);
+    std::vector<double> column(closes.size(), NOT_READY);
+    
+    // Window summed oldest to newest from zero, like RollingWindow::sum
+    for (size_t i = window - 1; i < closes.size(); ++i) {
+        double sum = 0.0;
+        for (size_t j = i + 1 - window; j <= i; ++j) sum += closes[j];
+        column[i] = sum / window;
+    }
+    return column;
+}
+
+std::vector<double> stddev(const std::vector<double>& closes, int period) {
+    check_period(period);
+    size_t window = static_cast<size_t>(period);
+    std::vector<double> means = sma(closes, period);
+    std::vector<double> column(closes.size(), NOT_READY);
+    
+    for (size_t i = window - 1; i < closes.size(); ++i) {
+        double variance = 0.0;
+        for (size_t j = i + 1 - window; j <= i; ++j) {
+            variance += (closes[j] - means[i]) * (closes[j] - means[i]);
+        }
+        column[i] = std::sqrt(variance / window);
+    }
+    return column;
+}
+
+std::vector<double> compute(IndicatorKind kind, const std::vector<double>& closes, int period) {
+    switch (kind) {
+        case IndicatorKind::EMA: return ema(closes, period);
+        case IndicatorKind::SMA: return sma(closes, period);
+        case IndicatorKind::StdDev: return stddev(closes, period);
+    }
+    throw std::invalid_argument("Unknown indicator kind");
+}
+
+void check_origin(const IndicatorValues& column, const MarketData& bar) {
+    if (!column.origin.empty() && bar.date != column.origin) {
+        throw std::invalid_argument(std::format("Indicator column starts on {} but the first bar is {}; "
+            "cached columns need the whole series they were computed over", column.origin, bar.date));
+    }
+}
+
+}
+
+IndicatorKey IndicatorKey::of(IndicatorKind kind, int period, const PriceSeries& series) {
+    bool empty = series.closes.empty();
+    return IndicatorKey{kind, period, series.id, series.closes.size(),
+                        empty ? 0 : bits_of(series.closes.front()), empty ? 0 : bits_of(series.closes.back())};
+}
+
+size_t IndicatorCache::KeyHash::operator()(const IndicatorKey& key) const noexcept {
+    uint64_t hash = key.series ^ key.bars;
+    hash ^= (static_cast<uint64_t>(key.kind) << 32 | static_cast<uint32_t>(key.period)) * 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+IndicatorCache::IndicatorCache(size_t budget_bytes)
+    : budget_bytes(budget_bytes), bytes(0), hits(0), misses(0), evictions(0) {}
+
+IndicatorColumn IndicatorCache::get(IndicatorKind kind, int period, const PriceSeries& series) {
+    IndicatorKey key = IndicatorKey::of(kind, period, series);
+    std::promise<IndicatorColumn> promise;
+    std::shared_future<IndicatorColumn> pending;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            hits++;
+            Entry& entry = it->second;
+            if (entry.ready) {
+                lru.splice(lru.begin(), lru, entry.lru);
+                return entry.column.get();
+            }
+            pending = entry.column;
+        } else {
+            misses++;
+            entries.emplace(key, Entry{promise.get_future().share(), 0, false, lru.end()});
+        }
+    }
+    
+    // Someone else is computing it: wait outside the lock
+    if (pending.valid()) {
+        return pending.get();
+    }
+    
+    IndicatorColumn column;
+    try {
+        column = std::make_shared<const IndicatorValues>(
+            IndicatorValues{series.origin, indicators::compute(kind, series.closes, period)});
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(key);
+        throw;
+    }
+    promise.set_value(column);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries.at(key);
+    entry.ready = true;
+    entry.bytes = column->values.size() * sizeof(double);
+    lru.push_front(key);
+    entry.lru = lru.begin();
+    bytes += entry.bytes;
+    evict_locked();
+    return column;
+}
+
+void IndicatorCache::evict_locked() {
+    while (bytes > budget_bytes && !lru.empty()) {
+        auto it = entries.find(lru.back());
+        bytes -= it->second.bytes;
+        entries.erase(it);
+        lru.pop_back();
+        evictions++;
+    }
+}
+
+void IndicatorCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& key : lru) {
+        entries.erase(key);
+    }
+    lru.clear();
+    bytes = 0;
+}
+
+IndicatorCacheStats IndicatorCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return IndicatorCacheStats{hits, misses, evictions, bytes, entries.size()};
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "../data_loader.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// One indicator value per bar; NaN until the indicator has enough history.
+// `origin` is the date of the series' first bar (empty when unknown), so a
+// consumer can check that its bars start where the column does.
+struct IndicatorValues {
+    std::string origin;
+    std::vector<double> values;
+};
+using IndicatorColumn = std::shared_ptr<const IndicatorValues>;
+
+enum class IndicatorKind : uint32_t {
+    EMA,        // Seeded with the first close, alpha = 2 / (period + 1)
+    SMA,
+    StdDev      // Population standard deviation over the window
+};
+
+// Close prices indicators are computed over, plus an identity for cache keys.
+// The id is a hash of the origin and closes, so the same data loaded twice (or
+// in two workers) maps to the same cache entries.
+struct PriceSeries {
+    uint64_t id;
+    std::string origin;     // Date of the first bar; empty when built from bare closes
+    std::vector<double> closes;
+    
+    static PriceSeries from_closes(std::vector<double> closes, std::string origin = {});
+    static PriceSeries from_market_data(const std::vector<MarketData>& data);
+};
+
+// Column computations. They match the strategies' own per-bar arithmetic
+// (same summation order, two-pass variance), so cached values are bit-identical
+// to recomputed ones. A column costs O(bars * period), once per cache entry.
+namespace indicators {
+
+std::vector<double> ema(const std::vector<double>& closes, int period);
+std::vector<double> sma(const std::vector<double>& closes, int period);
+std::vector<double> stddev(const std::vector<double>& closes, int period);
+
+std::vector<double> compute(IndicatorKind kind, const std::vector<double>& closes, int period);
+
+// Throws std::invalid_argument unless `bar` is the first bar `column` was computed over
+void check_origin(const IndicatorValues& column, const MarketData& bar);
+
+}
+
+// A hit needs the series' length and first and last closes to match as well
+// as its hash, so a hash collision alone cannot hand out another series' column
+struct IndicatorKey {
+    IndicatorKind kind;
+    int32_t period;
+    uint64_t series;        // PriceSeries::id
+    uint64_t bars;
+    uint64_t first_close;   // Bit patterns, so NaN closes still compare equal
+    uint64_t last_close;
+    
+    static IndicatorKey of(IndicatorKind kind, int period, const PriceSeries& series);
+    
+    bool operator==(const IndicatorKey&) const = default;
+};
+
+struct IndicatorCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t bytes;
+    size_t entries;
+};
+
+// Thread-safe memoized indicator columns shared across strategies and runs.
+// Each (kind, period, series) column is computed once; concurrent requests
+// for a column still being computed wait for that computation instead of
+// repeating it. Finished columns are evicted least recently used first
+// whenever the total exceeds the byte budget. Evicted columns stay alive for
+// holders of the shared pointer.
+class IndicatorCache {
+private:
+    struct KeyHash {
+        size_t operator()(const IndicatorKey& key) const noexcept;
+    };
+    
+    struct Entry {
+        std::shared_future<IndicatorColumn> column;
+        size_t bytes;
+        bool ready;
+        std::list<IndicatorKey>::iterator lru;
+    };
+    
+    mutable std::mutex mutex;
+    std::unordered_map<IndicatorKey, Entry, KeyHash> entries;
+    std::list<IndicatorKey> lru;   // Ready entries, most recently used first
+    size_t budget_bytes;
+    size_t bytes;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    
+    void evict_locked();
+
+public:
+    explicit IndicatorCache(size_t budget_bytes = 64 * 1024 * 1024);
+    
+    IndicatorCache(const IndicatorCache&) = delete;
+    IndicatorCache& operator=(const IndicatorCache&) = delete;
+    
+    // Column for `kind`/`period` over `series`, computed on first use.
+    // A failed computation is rethrown to every waiter and not cached.
+    IndicatorColumn get(IndicatorKind kind, int period, const PriceSeries& series);
+    
+    // Drop every finished column (columns still being computed are kept)
+    void clear();
+    
+    IndicatorCacheStats get_stats() const;
+    size_t get_budget() const { return budget_bytes; }
+};
@@ -0,0 +1,260 @@
+#include "risk_engine.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+
+constexpr size_t TILE = 64;
+
+// row[j] += ai * a[j] - bi * b[j] for one tile, Kahan-compensated through `carry`
+void tile_update(double* __restrict row, double* __restrict carry,
+                 const double* __restrict a, const double* __restrict b, double ai, double bi) {
+    for (size_t j = 0; j < TILE; ++j) {
+        double y = (ai * a[j] - bi * b[j]) - carry[j];
+        double t = row[j] + y;
+        carry[j] = (t - row[j]) - y;
+        row[j] = t;
+    }
+}
+
+// out[j] += scale * x[j] for one tile
+void tile_axpy(double* __restrict out, const double* __restrict x, double scale) {
+    for (size_t j = 0; j < TILE; ++j) {
+        out[j] += scale * x[j];
+    }
+}
+
+// Dot product over a multiple of four elements, four partial sums wide
+double dot(const double* __restrict a, const double* __restrict b, size_t count) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    for (size_t j = 0; j < count; j += 4) {
+        acc[0] += a[j] * b[j];
+        acc[1] += a[j + 1] * b[j + 1];
+        acc[2] += a[j + 2] * b[j + 2];
+        acc[3] += a[j + 3] * b[j + 3];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+}
+
+RiskEngine::RiskEngine(size_t num_assets, size_t window, double confidence)
+    : num_assets(num_assets), window(std::max<size_t>(window, 2)), confidence(confidence),
+      has_prev(false), head(0), observations(0) {
+    
+    static_assert(BLOCK == TILE);
+    if (num_assets == 0) {
+        throw std::invalid_argument("RiskEngine needs at least one asset");
+    }
+    if (confidence <= 0.5 || confidence >= 1.0) {
+        throw std::invalid_argument("RiskEngine confidence must be in (0.5, 1)");
+    }
+    
+    z_score = normal_quantile(confidence);
+    stride = (num_assets + BLOCK - 1) / BLOCK * BLOCK;
+    
+    prev_prices.assign(num_assets, 0.0);
+    history.assign(this->window * stride, 0.0);
+    sums.assign(num_assets, 0.0);
+    sum_carry.assign(num_assets, 0.0);
+    cross.assign(stride * stride, 0.0);
+    cross_carry.assign(stride * stride, 0.0);
+    zeros.assign(stride, 0.0);
+    current.assign(stride, 0.0);
+    padded_weights.assign(stride, 0.0);
+    cov_w.assign(stride, 0.0);
+    portfolio_returns.reserve(this->window);
+    report.risk_contributions.assign(num_assets, 0.0);
+}
+
+// cross += a a^T - b b^T over the tiles on and above the diagonal. Diagonal
+// tiles are updated whole, so their lower halves are valid too.
+void RiskEngine::rank_update(const double* added, const double* removed) {
+    for (size_t ib = 0; ib < num_assets; ib += BLOCK) {
+        size_t iend = std::min(ib + BLOCK, num_assets);
+        for (size_t jb = ib; jb < stride; jb += BLOCK) {
+            for (size_t i = ib; i < iend; ++i) {
+                size_t offset = i * stride + jb;
+                tile_update(cross.data() + offset, cross_carry.data() + offset,
+                            added + jb, removed + jb, added[i], removed[i]);
+            }
+        }
+    }
+}
+
+void RiskEngine::update(std::span<const double> prices) {
+    if (prices.size() != num_assets) {
+        throw std::invalid_argument("RiskEngine::update price count does not match asset count");
+    }
+    
+    // A non-finite price is a missing quote: its return is 0 and the previous
+    // price is held, so the next quote's return spans the gap. A NaN never
+    // reaches the sums, where it would stay after leaving the window.
+    for (size_t i = 0; i < num_assets; ++i) {
+        double price = prices[i];
+        if (!std::isfinite(price)) {
+            current[i] = 0.0;
+            continue;
+        }
+        current[i] = prev_prices[i] > 0 ? (price - prev_prices[i]) / prev_prices[i] : 0.0;
+        prev_prices[i] = price;
+    }
+    if (!has_prev) {
+        has_prev = true;
+        return;
+    }
+    
+    // Once the window is full the oldest return leaves as the newest enters: one rank-2 pass
+    double* slot = history.data() + head * stride;
+    const double* removed = observations == window ? slot : zeros.data();
+    
+    for (size_t i = 0; i < num_assets; ++i) {
+        double y = (current[i] - removed[i]) - sum_carry[i];
+        double t = sums[i] + y;
+        sum_carry[i] = (t - sums[i]) - y;
+        sums[i] = t;
+    }
+    rank_update(current.data(), removed);
+    
+    if (observations < window) observations++;
+    std::copy(current.begin(), current.end(), slot);
+    head = (head + 1) % window;
+}
+
+double RiskEngine::covariance(size_t i, size_t j) const {
+    if (observations < 2) return 0.0;
+    if (i > j) std::swap(i, j);
+    
+    double m = static_cast<double>(observations);
+    return (cross[i * stride + j] - sums[i] * sums[j] / m) / (m - 1.0);
+}
+
+const RiskReport& RiskEngine::evaluate(std::span<const double> weights) {
+    if (weights.size() != num_assets) {
+        throw std::invalid_argument("RiskEngine::evaluate weight count does not match asset count");
+    }
+    
+    const size_t n = num_assets;
+    report.observations = observations;
+    
+    if (observations < 2) {
+        report.expected_return = 0.0;
+        report.volatility = 0.0;
+        report.parametric_var = report.parametric_cvar = 0.0;
+        report.historical_var = report.historical_cvar = 0.0;
+        std::fill(report.risk_contributions.begin(), report.risk_contributions.end(), 0.0);
+        return report;
+    }
+    
+    std::copy(weights.begin(), weights.end(), padded_weights.begin());
+    const double* w = padded_weights.data();
+    double m = static_cast<double>(observations);
+    
+    // cov_w = C w from the stored tiles: a diagonal tile feeds its rows' dot
+    // products directly; a tile above it also feeds its columns (C is symmetric)
+    std::fill(cov_w.begin(), cov_w.end(), 0.0);
+    for (size_t ib = 0; ib < n; ib += BLOCK) {
+        size_t iend = std::min(ib + BLOCK, n);
+        for (size_t i = ib; i < iend; ++i) {
+            const double* row = cross.data() + i * stride;
+            double acc = dot(row + ib, w + ib, stride - ib);
+            for (size_t jb = ib + BLOCK; jb < stride; jb += BLOCK) {
+                tile_axpy(cov_w.data() + jb, row + jb, w[i]);
+            }
+            cov_w[i] += acc;
+        }
+    }
+    
+    // Centre: C = (cross - s s^T / m) / (m - 1)
+    double s_dot_w = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        s_dot_w += sums[i] * w[i];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        cov_w[i] = (cov_w[i] - sums[i] * s_dot_w / m) / (m - 1.0);
+    }
+    
+    double variance = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        variance += w[i] * cov_w[i];
+    }
+    double volatility = std::sqrt(std::max(variance, 0.0));
+    double mean = s_dot_w / m;
+    
+    report.expected_return = mean;
+    report.volatility = volatility;
+    
+    // Euler allocation: contributions add up to total volatility
+    for (size_t i = 0; i < n; ++i) {
+        report.risk_contributions[i] = volatility > 0 ? w[i] * cov_w[i] / volatility : 0.0;
+    }
+    
+    // Parametric (Gaussian) VaR / CVaR as positive loss fractions
+    double tail = 1.0 - confidence;
+    double density = std::exp(-0.5 * z_score * z_score) / std::sqrt(2.0 * M_PI);
+    report.parametric_var = z_score * volatility - mean;
+    report.parametric_cvar = volatility * density / tail - mean;
+    
+    // Historical VaR / CVaR from the window's portfolio losses
+    portfolio_returns.clear();
+    for (size_t k = 0; k < observations; ++k) {
+        portfolio_returns.push_back(-dot(history.data() + k * stride, w, stride));
+    }
+    
+    size_t var_index = static_cast<size_t>(std::ceil(confidence * observations)) - 1;
+    var_index = std::min(var_index, observations - 1);
+    std::nth_element(portfolio_returns.begin(), portfolio_returns.begin() + var_index, portfolio_returns.end());
+    report.historical_var = portfolio_returns[var_index];
+    
+    // Losses at or beyond VaR sit to the right of the partition point
+    double tail_sum = std::accumulate(portfolio_returns.begin() + var_index, portfolio_returns.end(), 0.0);
+    report.historical_cvar = tail_sum / (observations - var_index);
+    
+    return report;
+}
+
+const RiskReport& RiskEngine::evaluate_positions(std::span<const long> quantities, double total_value) {
+    if (quantities.size() != num_assets) {
+        throw std::invalid_argument("RiskEngine::evaluate_positions quantity count does not match asset count");
+    }
+    
+    // cov_w is rebuilt inside evaluate(), so borrow `current` for the weights
+    for (size_t i = 0; i < num_assets; ++i) {
+        current[i] = total_value > 0 ? quantities[i] * prev_prices[i] / total_value : 0.0;
+    }
+    return evaluate(current);
+}
+
+double RiskEngine::normal_quantile(double p) {
+    if (p <= 0.0 || p >= 1.0) {
+        throw std::invalid_argument("normal_quantile requires 0 < p < 1");
+    }
+    
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    
+    const double p_low = 0.02425;
+    if (p < p_low) {
+        double q = std::sqrt(-2.0 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - p_low) {
+        double q = std::sqrt(-2.0 * std::log(1.0 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
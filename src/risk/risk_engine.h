@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <cstddef>
+
+// Risk figures for one bar, all expressed as fractions of portfolio value
+struct RiskReport {
+    size_t observations;              // Returns currently in the rolling window
+    double expected_return;           // Mean one-bar portfolio return
+    double volatility;                // One-bar portfolio standard deviation
+    double parametric_var;            // Gaussian VaR at the configured confidence
+    double parametric_cvar;           // Gaussian expected shortfall
+    double historical_var;            // Empirical VaR over the window
+    double historical_cvar;           // Empirical expected shortfall
+    std::vector<double> risk_contributions;  // Per-asset share of volatility (sums to volatility)
+};
+
+// Incremental multi-asset risk over a rolling window of per-bar returns.
+//
+// Keeps the window's return sums and cross-product matrix (upper triangle)
+// up to date with a rank-1 update per bar (rank-2 once the window is full
+// and the oldest return drops out), so covariance is never recomputed from
+// scratch. The running sums are Kahan-compensated, which keeps them within a
+// few ULP of a fresh recompute however long the run, without a periodic
+// rebuild. Rows are padded to a whole number of BLOCK-wide tiles so the
+// inner loops have fixed trip counts and vectorize at -O2.
+class RiskEngine {
+private:
+    size_t num_assets;
+    size_t window;
+    double confidence;
+    double z_score;
+    
+    std::vector<double> prev_prices;
+    bool has_prev;
+    
+    size_t stride;                    // num_assets rounded up to a multiple of BLOCK
+    
+    std::vector<double> history;      // Ring buffer: window x stride returns (padding stays 0)
+    size_t head;                      // Slot the next return goes into
+    size_t observations;
+    
+    std::vector<double> sums;         // Per-asset return sums over the window
+    std::vector<double> sum_carry;    // Kahan compensation for `sums`
+    std::vector<double> cross;        // sum(r * r^T), row-major stride x stride; upper tiles only
+    std::vector<double> cross_carry;  // Kahan compensation for `cross`
+    std::vector<double> zeros;        // Stands in for the removed return while the window fills
+    
+    // Scratch reused across bars
+    std::vector<double> current;
+    std::vector<double> padded_weights;
+    std::vector<double> cov_w;
+    std::vector<double> portfolio_returns;
+    RiskReport report;
+    
+    static constexpr size_t BLOCK = 64;
+    
+    void rank_update(const double* added, const double* removed);
+    
+public:
+    RiskEngine(size_t num_assets, size_t window = 252, double confidence = 0.99);
+    
+    // Feed one bar of prices (one per asset); the return versus the previous bar enters the window.
+    // A NaN or infinite price counts as a missing quote: that asset's return is 0 and its
+    // last price is held, so the next quote's return is measured from it. Returns are also
+    // 0 until an asset has a positive price (before listing, say).
+    void update(std::span<const double> prices);
+    
+    // Risk of a book with the given weights (position value / portfolio value)
+    const RiskReport& evaluate(std::span<const double> weights);
+    
+    // Convenience: derive weights from share quantities and the latest prices
+    const RiskReport& evaluate_positions(std::span<const long> quantities, double total_value);
+    
+    // Sample covariance of assets i and j over the current window
+    double covariance(size_t i, size_t j) const;
+    
+    size_t get_num_assets() const { return num_assets; }
+    size_t get_observations() const { return observations; }
+    
+    // Standard normal quantile (Acklam's rational approximation)
+    static double normal_quantile(double p);
+};
@@ -0,0 +1,49 @@
+#include "run_arena.h"
+#include <memory>
+#include <algorithm>
+#include <new>
+
+RunArena::RunArena(size_t initial_bytes)
+    : buffer(initial_bytes), used(0), overflow(nullptr), overflow_bytes(0) {}
+
+RunArena::~RunArena() {
+    release_overflow();
+}
+
+void* RunArena::do_allocate(size_t bytes, size_t alignment) {
+    void* ptr = buffer.data() + used;
+    size_t space = buffer.size() - used;
+    if (std::align(alignment, bytes, ptr, space)) {
+        used = buffer.size() - space + bytes;
+        return ptr;
+    }
+    
+    // Out of room: fall back to the heap for the rest of this run. The payload
+    // follows the block header, padded to the requested alignment.
+    alignment = std::max(alignment, alignof(OverflowBlock));
+    size_t offset = (sizeof(OverflowBlock) + alignment - 1) / alignment * alignment;
+    void* memory = std::pmr::new_delete_resource()->allocate(offset + bytes, alignment);
+    overflow = ::new (memory) OverflowBlock{overflow, offset + bytes, alignment};
+    overflow_bytes += bytes;
+    return static_cast<std::byte*>(memory) + offset;
+}
+
+void RunArena::release_overflow() {
+    while (overflow) {
+        OverflowBlock block = *overflow;
+        std::pmr::new_delete_resource()->deallocate(overflow, block.bytes, block.alignment);
+        overflow = block.next;
+    }
+}
+
+void RunArena::reset() {
+    release_overflow();
+    
+    if (overflow_bytes > 0) {
+        size_t needed = used + overflow_bytes;
+        buffer.assign(needed * 2, std::byte{0});
+    }
+    
+    used = 0;
+    overflow_bytes = 0;
+}
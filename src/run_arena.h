@@ -0,0 +1,44 @@
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+
+// Per-run bump allocator for trade storage and other run-scoped data.
+//
+// Allocations are carved out of one buffer and never freed individually;
+// reset() rewinds the whole arena between runs. If a run outgrows the
+// buffer, the excess comes from the heap and the buffer is enlarged on the
+// next reset(), so repeated runs settle into zero heap allocations.
+class RunArena : public std::pmr::memory_resource {
+private:
+    std::vector<std::byte> buffer;
+    size_t used;
+    
+    // Header at the start of each heap block, so the overflow list needs no storage of its own
+    struct OverflowBlock {
+        OverflowBlock* next;
+        size_t bytes;       // Whole block, header included
+        size_t alignment;
+    };
+    OverflowBlock* overflow;
+    size_t overflow_bytes;
+    
+    void release_overflow();
+    
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    
+public:
+    explicit RunArena(size_t initial_bytes = 64 * 1024);
+    ~RunArena() override;
+    
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+    
+    // Invalidate everything handed out so far; grow if the last run overflowed
+    void reset();
+    
+    size_t capacity() const { return buffer.size(); }
+    size_t bytes_used() const { return used + overflow_bytes; }
+};
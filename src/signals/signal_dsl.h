@@ -0,0 +1,553 @@
+#pragma once
+#include "../data_loader.h"
+#include "../backtester.h"
+#include <vector>
+#include <string>
+#include <concepts>
+#include <algorithm>
+#include <functional>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <cmath>
+
+// Embedded signal DSL.
+//
+//   using namespace signals;
+//   using signals::close;  // POSIX ::close is usually visible too
+//   auto strategy = SignalStrategy(cross_above(ema(close, 12), ema(close, 26)),
+//                                  cross_below(ema(close, 12), ema(close, 26)),
+//                                  "EMA Crossover DSL");
+//
+// Every expression is its own type, so a strategy compiles into one fused
+// on_bar with no virtual calls. Indicator state (EMA seeds, rolling windows)
+// is sized at construction and never allocates per bar. Structurally equal
+// stateful sub-expressions - the two ema(close, 12) above, or the window
+// shared by sma(close, 20) and bollinger_lower(20, 2.0) - are linked when the
+// strategy is built.
+//
+// Linking also fixes the per-bar schedule: the distinct stateful nodes are
+// collected by type, children before parents, and on_bar steps exactly those.
+// A linked duplicate is never visited per bar; it only reads its
+// representative's state, so nothing is tested or updated twice. Once every
+// scheduled node is warm, on_bar switches to step_warm(), which drops the
+// seeding and readiness checks for the rest of the run; if the exit rule only
+// repeats the entry rule's indicators, the entry rule is stepped in place.
+namespace signals {
+
+template<typename... Ts>
+struct TypeList {};
+
+template<typename T>
+concept SignalNode = requires(T node, const T& other, const MarketData& bar) {
+    typename T::Inputs;
+    node.value(bar);
+    { node.ready() } -> std::convertible_to<bool>;
+    { node.same_as(other) } -> std::convertible_to<bool>;
+    node.visit([](auto&) {});
+};
+
+// Nodes that hold per-bar state and are stepped by the schedule. Once warm()
+// (seeded, window full, previous values held) a node stays warm and ready,
+// and step_warm() does the same update as step() without the warm-up checks.
+template<typename T>
+concept SteppedNode = SignalNode<T> && requires(T node, const T& other, const MarketData& bar) {
+    node.step(bar);
+    node.step_warm(bar);
+    { other.warm() } -> std::convertible_to<bool>;
+    node.link(other);
+};
+
+// ---------------------------------------------------------------------------
+// Leaves
+
+template<double MarketData::*Field>
+struct PriceField {
+    using Inputs = TypeList<>;
+    
+    double value(const MarketData& bar) const { return bar.*Field; }
+    bool ready() const { return true; }
+    bool same_as(const PriceField&) const { return true; }
+    template<typename F> void visit(F&& f) { f(*this); }
+};
+
+struct VolumeField {
+    using Inputs = TypeList<>;
+    
+    double value(const MarketData& bar) const { return static_cast<double>(bar.volume); }
+    bool ready() const { return true; }
+    bool same_as(const VolumeField&) const { return true; }
+    template<typename F> void visit(F&& f) { f(*this); }
+};
+
+struct Constant {
+    using Inputs = TypeList<>;
+    double constant;
+    
+    double value(const MarketData&) const { return constant; }
+    bool ready() const { return true; }
+    bool same_as(const Constant& other) const { return constant == other.constant; }
+    template<typename F> void visit(F&& f) { f(*this); }
+};
+
+inline constexpr PriceField<&MarketData::open> open{};
+inline constexpr PriceField<&MarketData::high> high{};
+inline constexpr PriceField<&MarketData::low> low{};
+inline constexpr PriceField<&MarketData::close> close{};
+inline constexpr VolumeField volume{};
+
+// ---------------------------------------------------------------------------
+// Stateful indicators. link() points reads at the node itself or at the
+// equal node it shares state with. step() assumes the inputs have already
+// been stepped this bar.
+
+template<SignalNode Src>
+struct Ema {
+    using Inputs = TypeList<Src>;
+    Src src;
+    double alpha;
+    double decay;
+    double current = 0.0;
+    int seen = 0;
+    const Ema* state = this;
+    
+    Ema(Src s, int period) : src(s), alpha(2.0 / (period + 1.0)), decay(1.0 - alpha) {}
+    
+    void step(const MarketData& bar) {
+        if (!src.ready()) return;
+        
+        // Seeded with the first value; meaningful once it has absorbed a second
+        double x = src.value(bar);
+        current = seen == 0 ? x : alpha * x + decay * current;
+        seen += seen < 2;
+    }
+    void step_warm(const MarketData& bar) { current = alpha * src.value(bar) + decay * current; }
+    bool warm() const { return seen >= 2; }
+    void link(const Ema& representative) { state = &representative; }
+    double value(const MarketData&) const { return state->current; }
+    bool ready() const { return state->seen >= 2; }
+    bool same_as(const Ema& other) const { return alpha == other.alpha && src.same_as(other.src); }
+    template<typename F> void visit(F&& f) { f(*this); src.visit(f); }
+};
+
+// Rolling window shared by mean and stddev. The mean is re-summed oldest to
+// newest each bar and the stddev is two-pass around it, the same arithmetic as
+// RollingWindow::sum() and MeanReversionStrategy, so DSL strategies trade bar
+// for bar like the hand-written ones. The stddev is computed on first use.
+template<SignalNode Src>
+struct Window {
+    using Inputs = TypeList<Src>;
+    Src src;
+    size_t period;
+    std::vector<double> values;
+    size_t head = 0;        // Next slot written; the oldest value once full
+    size_t count = 0;
+    double mean_value = 0.0;
+    mutable double stddev_value = 0.0;
+    mutable bool has_stddev = false;
+    const Window* state = this;
+    
+    Window(Src s, int n) : src(s), period(static_cast<size_t>(std::max(n, 1))), values(period, 0.0) {}
+    
+    void step(const MarketData& bar) {
+        if (!src.ready()) return;
+        
+        values[head] = src.value(bar);
+        head = head + 1 == period ? 0 : head + 1;
+        if (count < period) count++;
+        if (count == period) summarize();
+    }
+    void step_warm(const MarketData& bar) {
+        values[head] = src.value(bar);
+        head = head + 1 == period ? 0 : head + 1;
+        summarize();
+    }
+    
+    // Visit values oldest to newest (the window must be full)
+    template<typename F>
+    void for_each(F&& fn) const {
+        for (size_t i = head; i < period; ++i) fn(values[i]);
+        for (size_t i = 0; i < head; ++i) fn(values[i]);
+    }
+    void summarize() {
+        double total = 0.0;
+        for_each([&](double value) { total += value; });
+        mean_value = total / period;
+        has_stddev = false;
+    }
+    
+    bool warm() const { return count == period; }
+    void link(const Window& representative) { state = &representative; }
+    bool ready() const { return state->count == period; }
+    double mean() const { return state->mean_value; }
+    double stddev() const {
+        const Window& w = *state;
+        if (!w.has_stddev) {
+            double variance = 0.0;
+            w.for_each([&](double value) { variance += (value - w.mean_value) * (value - w.mean_value); });
+            w.stddev_value = std::sqrt(variance / w.period);
+            w.has_stddev = true;
+        }
+        return w.stddev_value;
+    }
+    double value(const MarketData&) const { return mean(); }
+    bool same_as(const Window& other) const { return period == other.period && src.same_as(other.src); }
+    template<typename F> void visit(F&& f) { f(*this); src.visit(f); }
+};
+
+template<SignalNode Src>
+struct Mean {
+    using Inputs = TypeList<Window<Src>>;
+    Window<Src> window;
+    
+    double value(const MarketData&) const { return window.mean(); }
+    bool ready() const { return window.ready(); }
+    bool same_as(const Mean& other) const { return window.same_as(other.window); }
+    template<typename F> void visit(F&& f) { f(*this); window.visit(f); }
+};
+
+template<SignalNode Src>
+struct StdDev {
+    using Inputs = TypeList<Window<Src>>;
+    Window<Src> window;
+    
+    double value(const MarketData&) const { return window.stddev(); }
+    bool ready() const { return window.ready(); }
+    bool same_as(const StdDev& other) const { return window.same_as(other.window); }
+    template<typename F> void visit(F&& f) { f(*this); window.visit(f); }
+};
+
+// ---------------------------------------------------------------------------
+// Combinators
+
+template<SignalNode L, SignalNode R, typename Op>
+struct Binary {
+    using Inputs = TypeList<L, R>;
+    L lhs;
+    R rhs;
+    
+    auto value(const MarketData& bar) const { return Op{}(lhs.value(bar), rhs.value(bar)); }
+    bool ready() const { return lhs.ready() && rhs.ready(); }
+    bool same_as(const Binary& other) const { return lhs.same_as(other.lhs) && rhs.same_as(other.rhs); }
+    template<typename F> void visit(F&& f) { f(*this); lhs.visit(f); rhs.visit(f); }
+};
+
+// Fires on the bar where lhs moves from <= rhs to > rhs (above) or from
+// >= rhs to < rhs (below). Both directions are tracked, so cross_above(a, b)
+// and cross_below(a, b) in one strategy link to a single node, and `fired`
+// points at the flag for this node's direction. The previous bar's comparison
+// is kept here rather than in the inputs, which may be linked.
+template<SignalNode L, SignalNode R>
+struct Cross {
+    using Inputs = TypeList<L, R>;
+    L lhs;
+    R rhs;
+    bool above;
+    bool was_at_or_below = false;   // Previous bar's lhs <= rhs
+    bool was_at_or_above = false;
+    bool has_prev = false;
+    bool fired_above = false;
+    bool fired_below = false;
+    const bool* fired = above ? &fired_above : &fired_below;
+    
+    Cross(L l, R r, bool above) : lhs(l), rhs(r), above(above) {}
+    
+    void step(const MarketData& bar) {
+        if (!lhs.ready() || !rhs.ready()) return;
+        
+        step_warm(bar);
+        has_prev = true;
+    }
+    void step_warm(const MarketData& bar) {
+        double l = lhs.value(bar);
+        double r = rhs.value(bar);
+        fired_above = was_at_or_below & (l > r);
+        fired_below = was_at_or_above & (l < r);
+        was_at_or_below = l <= r;
+        was_at_or_above = l >= r;
+    }
+    bool warm() const { return has_prev; }
+    void link(const Cross& representative) {
+        fired = above ? &representative.fired_above : &representative.fired_below;
+    }
+    bool value(const MarketData&) const { return *fired; }
+    bool ready() const { return true; }
+    bool same_as(const Cross& other) const { return lhs.same_as(other.lhs) && rhs.same_as(other.rhs); }
+    template<typename F> void visit(F&& f) { f(*this); lhs.visit(f); rhs.visit(f); }
+};
+
+// ---------------------------------------------------------------------------
+// Builders
+
+template<typename T>
+concept Operand = SignalNode<std::remove_cvref_t<T>> || std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+template<Operand T>
+auto as_node(T&& operand) {
+    if constexpr (std::is_arithmetic_v<std::remove_cvref_t<T>>) {
+        return Constant{static_cast<double>(operand)};
+    } else {
+        return std::remove_cvref_t<T>(operand);
+    }
+}
+
+template<typename A, typename B>
+concept NodeOperands = Operand<A> && Operand<B> &&
+    (SignalNode<std::remove_cvref_t<A>> || SignalNode<std::remove_cvref_t<B>>);
+
+template<typename Op, typename A, typename B>
+auto make_binary(A&& a, B&& b) {
+    auto lhs = as_node(std::forward<A>(a));
+    auto rhs = as_node(std::forward<B>(b));
+    return Binary<decltype(lhs), decltype(rhs), Op>{lhs, rhs};
+}
+
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator+(A&& a, B&& b) { return make_binary<std::plus<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator-(A&& a, B&& b) { return make_binary<std::minus<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator*(A&& a, B&& b) { return make_binary<std::multiplies<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator/(A&& a, B&& b) { return make_binary<std::divides<>>(std::forward<A>(a), std::forward<B>(b)); }
+
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator<(A&& a, B&& b) { return make_binary<std::less<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator<=(A&& a, B&& b) { return make_binary<std::less_equal<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator>(A&& a, B&& b) { return make_binary<std::greater<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator>=(A&& a, B&& b) { return make_binary<std::greater_equal<>>(std::forward<A>(a), std::forward<B>(b)); }
+
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator&&(A&& a, B&& b) { return make_binary<std::logical_and<>>(std::forward<A>(a), std::forward<B>(b)); }
+template<typename A, typename B> requires NodeOperands<A, B>
+auto operator||(A&& a, B&& b) { return make_binary<std::logical_or<>>(std::forward<A>(a), std::forward<B>(b)); }
+
+template<SignalNode Src>
+auto ema(Src src, int period) { return Ema<Src>(src, period); }
+
+template<SignalNode Src>
+auto sma(Src src, int period) { return Mean<Src>{Window<Src>(src, period)}; }
+
+template<SignalNode Src>
+auto stddev(Src src, int period) { return StdDev<Src>{Window<Src>(src, period)}; }
+
+template<SignalNode Src>
+auto bollinger_upper(Src src, int period, double multiplier) { return sma(src, period) + multiplier * stddev(src, period); }
+
+template<SignalNode Src>
+auto bollinger_lower(Src src, int period, double multiplier) { return sma(src, period) - multiplier * stddev(src, period); }
+
+inline auto bollinger_upper(int period, double multiplier) { return bollinger_upper(close, period, multiplier); }
+inline auto bollinger_lower(int period, double multiplier) { return bollinger_lower(close, period, multiplier); }
+
+template<SignalNode L, SignalNode R>
+auto cross_above(L lhs, R rhs) { return Cross<L, R>(lhs, rhs, true); }
+
+template<SignalNode L, SignalNode R>
+auto cross_below(L lhs, R rhs) { return Cross<L, R>(lhs, rhs, false); }
+
+// ---------------------------------------------------------------------------
+// Step schedule: the stepped node types of an expression, inputs before the
+// nodes that read them, each type listed once.
+
+namespace detail {
+
+template<typename List, typename T>
+struct Append;
+
+template<typename... Ts, typename T>
+struct Append<TypeList<Ts...>, T> {
+    using type = std::conditional_t<(std::is_same_v<Ts, T> || ...), TypeList<Ts...>, TypeList<Ts..., T>>;
+};
+
+template<typename List, typename Nodes>
+struct Collect { using type = List; };
+
+template<typename List, typename Node, typename... Rest>
+struct Collect<List, TypeList<Node, Rest...>> {
+    using with_inputs = typename Collect<List, typename Node::Inputs>::type;
+    using with_node = std::conditional_t<SteppedNode<Node>, typename Append<with_inputs, Node>::type, with_inputs>;
+    using type = typename Collect<with_node, TypeList<Rest...>>::type;
+};
+
+// Occurrences of node type T in the expression `Node`
+template<typename T, typename Node>
+constexpr size_t count_nodes();
+
+template<typename T, typename... Inputs>
+constexpr size_t count_inputs(TypeList<Inputs...>) { return (count_nodes<T, Inputs>() + ... + 0); }
+
+template<typename T, typename Node>
+constexpr size_t count_nodes() { return std::is_same_v<T, Node> + count_inputs<T>(typename Node::Inputs{}); }
+
+// The distinct nodes of one stepped type, sized for the worst case of no sharing
+template<typename T, size_t N>
+struct Bucket {
+    std::array<T*, N> nodes{};
+    size_t size = 0;
+    
+    void step(const MarketData& bar) const {
+        for (size_t i = 0; i < size; ++i) nodes[i]->step(bar);
+    }
+    // Unrolled over the capacity. The first node of a type is always scheduled,
+    // so slot 0 needs no size check.
+    void step_warm(const MarketData& bar) const {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((I == 0 || I < size ? nodes[I]->step_warm(bar) : void()), ...);
+        }(std::make_index_sequence<N>{});
+    }
+    bool warm() const {
+        return std::all_of(nodes.begin(), nodes.begin() + size, [](const T* node) { return node->warm(); });
+    }
+};
+
+template<typename List, typename Entry, typename Exit>
+struct Buckets;
+
+template<typename... Ts, typename Entry, typename Exit>
+struct Buckets<TypeList<Ts...>, Entry, Exit> {
+    using type = std::tuple<Bucket<Ts, count_nodes<Ts, Entry>() + count_nodes<Ts, Exit>()>...>;
+};
+
+}
+
+// ---------------------------------------------------------------------------
+// Compiled strategy: enter a fixed lot when flat and `entry` fires, exit a lot
+// when `exit` fires. With `scale_in`, every entry signal buys another lot while
+// cash allows, as the hand-written crossovers do when the averages touch and
+// cross above again. Satisfies TradingStrategy without a vtable.
+
+template<SignalNode Entry, SignalNode Exit>
+class SignalStrategy {
+private:
+    using Order = typename detail::Collect<TypeList<>, TypeList<Entry, Exit>>::type;
+    
+    Entry entry;
+    Exit exit;
+    std::string name;
+    std::string symbol;
+    long quantity;
+    double commission;
+    bool scale_in;
+    typename detail::Buckets<Order, Entry, Exit>::type schedule;
+    
+    // Once every scheduled node is warm, on_bar uses step_warm(). When the exit
+    // rule links entirely to the entry rule and the entry rule has no internal
+    // sharing (the usual mirrored crossover), the schedule is just the entry
+    // rule's stepped nodes, so they are stepped in place without the schedule.
+    enum class Phase { WarmingUp, Warm, WarmEntryOnly };
+    Phase phase = Phase::WarmingUp;
+    bool entry_only = true;     // Set by link()
+    
+    // Point each stepped node at the first structurally equal node (in visit
+    // order) and schedule only those first nodes. Built once, not per bar.
+    void link() {
+        std::apply([](auto&... bucket) { ((bucket.size = 0), ...); }, schedule);
+        
+        entry_only = true;
+        bool in_exit = false;
+        auto bind = [&](auto& node) {
+            using Node = std::remove_cvref_t<decltype(node)>;
+            if constexpr (SteppedNode<Node>) {
+                auto& bucket = std::get<detail::Bucket<Node, detail::count_nodes<Node, Entry>() +
+                                                             detail::count_nodes<Node, Exit>()>>(schedule);
+                auto first = bucket.nodes.begin();
+                auto last = first + bucket.size;
+                auto equal = std::find_if(first, last, [&](const Node* candidate) { return candidate->same_as(node); });
+                bool representative = equal == last;
+                if (representative) {
+                    node.link(node);
+                    bucket.nodes[bucket.size++] = &node;
+                } else {
+                    node.link(**equal);
+                }
+                entry_only &= representative != in_exit;
+            }
+        };
+        entry.visit(bind);
+        in_exit = true;
+        exit.visit(bind);
+    }
+    
+    // The entry rule's stepped nodes, one type at a time in schedule order
+    void step_entry(const MarketData& bar) {
+        [&]<typename... Ts>(TypeList<Ts...>) {
+            (entry.visit([&](auto& node) {
+                if constexpr (std::is_same_v<std::remove_cvref_t<decltype(node)>, Ts>) node.step_warm(bar);
+            }), ...);
+        }(Order{});
+    }
+    
+    // Only the first few bars take this path, so it stays out of the bar loop
+    [[gnu::noinline]] void warm_up(const MarketData& bar) {
+        std::apply([&](auto&... bucket) { (bucket.step(bar), ...); }, schedule);
+        if (std::apply([](const auto&... bucket) { return (bucket.warm() && ...); }, schedule)) {
+            phase = entry_only ? Phase::WarmEntryOnly : Phase::Warm;
+        }
+    }
+
+public:
+    SignalStrategy(Entry entry, Exit exit, std::string name, std::string symbol = "QQQM",
+                   long quantity = 100, double commission = 1.0, bool scale_in = false)
+        : entry(std::move(entry)), exit(std::move(exit)), name(std::move(name)),
+          symbol(std::move(symbol)), quantity(quantity), commission(commission), scale_in(scale_in) {
+        link();
+    }
+    
+    // Linked reads and the schedule point into this object, so copies must relink
+    SignalStrategy(const SignalStrategy& other)
+        : entry(other.entry), exit(other.exit), name(other.name),
+          symbol(other.symbol), quantity(other.quantity), commission(other.commission),
+          scale_in(other.scale_in), phase(other.phase) {
+        link();
+    }
+    SignalStrategy& operator=(const SignalStrategy&) = delete;
+    
+    // Forced into the backtester's bar loop: in a large translation unit GCC
+    // otherwise leaves it as a call, which costs more than the step itself
+    [[gnu::always_inline, gnu::flatten]] void on_bar(const MarketData& bar, Portfolio& portfolio) {
+        if (phase == Phase::WarmEntryOnly) [[likely]] {
+            step_entry(bar);
+        } else if (phase == Phase::Warm) {
+            std::apply([&](auto&... bucket) { (bucket.step_warm(bar), ...); }, schedule);
+        } else {
+            warm_up(bar);
+        }
+        
+        if ((scale_in || portfolio.position == 0) && entry.ready() && entry.value(bar)) {
+            if (portfolio.cash > bar.close * quantity) {
+                portfolio.buy(bar.date, symbol, bar.close, quantity, commission);
+            }
+        } else if (portfolio.position > 0 && exit.ready() && exit.value(bar)) {
+            long sell_qty = std::min(portfolio.position, quantity);
+            portfolio.sell(bar.date, symbol, bar.close, sell_qty, commission);
+        }
+    }
+    
+    std::string get_name() const { return name; }
+};
+
+// DSL equivalents of the hand-written strategies, trade for trade
+inline auto sma_crossover(int short_w = 10, int long_w = 30) {
+    return SignalStrategy(cross_above(sma(close, short_w), sma(close, long_w)),
+                          cross_below(sma(close, short_w), sma(close, long_w)),
+                          "SMA Crossover (DSL)", "QQQM", 100, 1.0, true);
+}
+
+inline auto ema_crossover(int short_w = 12, int long_w = 26) {
+    return SignalStrategy(cross_above(ema(close, short_w), ema(close, long_w)),
+                          cross_below(ema(close, short_w), ema(close, long_w)),
+                          "EMA Crossover (DSL)", "QQQM", 100, 1.0, true);
+}
+
+inline auto mean_reversion(int period = 20, double multiplier = 2.0) {
+    return SignalStrategy(close <= bollinger_lower(period, multiplier),
+                          close >= sma(close, period),
+                          "Mean Reversion (DSL)");
+}
+
+}
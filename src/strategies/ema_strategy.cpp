@@ -2,22 +2,31 @@
 #include <algorithm>
 
 void EMACrossoverStrategy::on_bar(const MarketData& bar, Portfolio& portfolio) {
-    if (!initialized) {
-        // Initialize EMAs with first price
-        short_ema = bar.close;
-        long_ema = bar.close;
-        initialized = true;
-        return;
+    if (cached_short) {
+        // The columns start from the first close, which only seeds the EMAs
+        size_t index = bar_index++;
+        if (index == 0) {
+            indicators::check_origin(*cached_short, bar);
+            indicators::check_origin(*cached_long, bar);
+            return;
+        }
+        short_ema = cached_short->values.at(index);
+        long_ema = cached_long->values.at(index);
+    } else {
+        if (!initialized) {
+            // Initialize EMAs with first price
+            short_ema = bar.close;
+            long_ema = bar.close;
+            initialized = true;
+            return;
+        }
+        
+        // Update EMAs using exponential smoothing
+        short_ema = short_alpha * bar.close + (1.0 - short_alpha) * short_ema;
+        long_ema = long_alpha * bar.close + (1.0 - long_alpha) * long_ema;
     }
     
-    // Update EMAs using exponential smoothing
-    short_ema = short_alpha * bar.close + (1.0 - short_alpha) * short_ema;
-    long_ema = long_alpha * bar.close + (1.0 - long_alpha) * long_ema;
-    
     // Trading logic: Buy when short EMA crosses above long EMA, sell when it crosses below
-    static double prev_short_ema = 0.0;
-    static double prev_long_ema = 0.0;
-    
     if (prev_short_ema > 0 && prev_long_ema > 0) {
         // Buy signal: short EMA crosses above long EMA
         if (prev_short_ema <= prev_long_ema && short_ema > long_ema) {
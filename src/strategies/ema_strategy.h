@@ -1,6 +1,7 @@
 #pragma once
 #include "../data_loader.h"
 #include "../backtester.h"
+#include "../indicators/indicator_cache.h"
 
 // Exponential moving average crossover strategy
 class EMACrossoverStrategy : public Strategy {
@@ -11,8 +12,15 @@ private:
     double long_ema;
     double short_alpha;
     double long_alpha;
+    double prev_short_ema;
+    double prev_long_ema;
     bool initialized;
     
+    // Precomputed EMA columns (e.g. from IndicatorCache), read by bar index instead of smoothing here
+    IndicatorColumn cached_short;
+    IndicatorColumn cached_long;
+    size_t bar_index;
+    
     double calculate_alpha(int period) const {
         return 2.0 / (period + 1.0);
     }
@@ -20,11 +28,20 @@ private:
 public:
     EMACrossoverStrategy(int short_w = 12, int long_w = 26) 
         : short_window(short_w), long_window(long_w), 
-          short_ema(0.0), long_ema(0.0), initialized(false) {
+          short_ema(0.0), long_ema(0.0), 
+          prev_short_ema(0.0), prev_long_ema(0.0), initialized(false), bar_index(0) {
         short_alpha = calculate_alpha(short_window);
         long_alpha = calculate_alpha(long_window);
     }
     
+    // Bars must arrive in the order the columns were computed over, starting with the
+    // series' first bar; on_bar throws std::invalid_argument if the first bar is another date
+    EMACrossoverStrategy(int short_w, int long_w, IndicatorColumn short_column, IndicatorColumn long_column) 
+        : EMACrossoverStrategy(short_w, long_w) {
+        cached_short = std::move(short_column);
+        cached_long = std::move(long_column);
+    }
+    
     ~EMACrossoverStrategy() override = default;
     
     void on_bar(const MarketData& bar, Portfolio& portfolio) override;
@@ -1,44 +1,52 @@
 #include "mean_reversion_strategy.h"
 #include <algorithm>
-#include <numeric>
 #include <cmath>
 
 void MeanReversionStrategy::on_bar(const MarketData& bar, Portfolio& portfolio) {
-    // Add current price to price history
-    prices.push_back(bar.close);
+    double std_dev;
     
-    // Keep only the lookback period
-    if (prices.size() > static_cast<size_t>(lookback_period)) {
-        prices.erase(prices.begin());
-    }
-    
-    // Need enough data to calculate Bollinger Bands
-    if (prices.size() < static_cast<size_t>(lookback_period)) {
-        return;
-    }
-    
-    // Calculate Simple Moving Average
-    sma = std::accumulate(prices.begin(), prices.end(), 0.0) / prices.size();
-    
-    // Calculate Standard Deviation
-    double variance = 0.0;
-    for (double price : prices) {
-        variance += (price - sma) * (price - sma);
+    if (cached_sma) {
+        // Columns are NaN until the lookback window is full
+        size_t index = bar_index++;
+        if (index == 0) {
+            indicators::check_origin(*cached_sma, bar);
+            indicators::check_origin(*cached_stddev, bar);
+        }
+        if (std::isnan(cached_sma->values.at(index))) {
+            return;
+        }
+        sma = cached_sma->values[index];
+        std_dev = cached_stddev->values.at(index);
+    } else {
+        // Add current price to the lookback window (oldest price drops out once full)
+        prices.push(bar.close);
+        
+        // Need enough data to calculate Bollinger Bands
+        if (!prices.full()) {
+            return;
+        }
+        
+        // Calculate Simple Moving Average
+        sma = prices.sum() / prices.size();
+        
+        // Calculate Standard Deviation
+        double variance = 0.0;
+        prices.for_each([&](double price) {
+            variance += (price - sma) * (price - sma);
+        });
+        std_dev = std::sqrt(variance / prices.size());
     }
-    double std_dev = std::sqrt(variance / prices.size());
     
     // Calculate Bollinger Bands
     upper_band = sma + (std_multiplier * std_dev);
     lower_band = sma - (std_multiplier * std_dev);
     
     // Mean reversion trading logic
-    static bool in_position = false;
-    
     // Buy signal: Price touches or goes below lower band (oversold)
     if (bar.close <= lower_band && !in_position) {
         if (portfolio.cash > bar.close * 100) {
             portfolio.buy(bar.date, "QQQM", bar.close, 100, 1.0);
-            in_position = true;
+            in_position = portfolio.position > 0;   // buy() refuses if the commission exceeds the cash left
         }
     }
     // Sell signal: Price touches or goes above upper band (overbought)
@@ -1,6 +1,8 @@
 #pragma once
 #include "../data_loader.h"
 #include "../backtester.h"
+#include "rolling_window.h"
+#include "../indicators/indicator_cache.h"
 #include <vector>
 #include <cmath>
 
@@ -9,16 +11,29 @@ class MeanReversionStrategy : public Strategy {
 private:
     int lookback_period;
     double std_multiplier;
-    std::vector<double> prices;
+    RollingWindow<double> prices;
     double sma;
     double upper_band;
     double lower_band;
+    bool in_position;
     bool initialized;
     
+    // Precomputed SMA/StdDev columns (e.g. from IndicatorCache), read by bar index instead of the window
+    IndicatorColumn cached_sma;
+    IndicatorColumn cached_stddev;
+    size_t bar_index;
+    
 public:
     MeanReversionStrategy(int period = 20, double multiplier = 2.0) 
-        : lookback_period(period), std_multiplier(multiplier), 
-          sma(0.0), upper_band(0.0), lower_band(0.0), initialized(false) {}
+        : lookback_period(period), std_multiplier(multiplier), prices(period),
+          sma(0.0), upper_band(0.0), lower_band(0.0), in_position(false), initialized(false), bar_index(0) {}
+    
+    // Bars must arrive in the order the columns were computed over, starting with the
+    // series' first bar; on_bar throws std::invalid_argument if the first bar is another date
+    MeanReversionStrategy(int period, double multiplier, IndicatorColumn sma_column, IndicatorColumn stddev_column) 
+        : lookback_period(period), std_multiplier(multiplier), prices(0),
+          sma(0.0), upper_band(0.0), lower_band(0.0), in_position(false), initialized(false),
+          cached_sma(std::move(sma_column)), cached_stddev(std::move(stddev_column)), bar_index(0) {}
     
     ~MeanReversionStrategy() override = default;
     
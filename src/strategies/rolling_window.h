@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Fixed-capacity ring buffer of the most recent values. Storage is allocated
+// once in the constructor, so pushing on every bar never touches the heap.
+// Visiting order is oldest to newest, the same order the old
+// push_back/erase(begin) vectors were summed in, so averages come out
+// bit-identical.
+template<typename T>
+class RollingWindow {
+private:
+    std::vector<T> values;
+    size_t head;    // Index of the oldest value once the window is full
+    size_t count;
+
+public:
+    explicit RollingWindow(size_t capacity)
+        : values(capacity), head(0), count(0) {}
+
+    void push(T value) {
+        if (values.empty()) return;
+        if (count < values.size()) {
+            values[count++] = value;
+            return;
+        }
+        values[head] = value;
+        head = (head + 1) % values.size();
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return values.size(); }
+    bool full() const { return count == values.size(); }
+
+    // Visit values oldest to newest
+    template<typename F>
+    void for_each(F&& fn) const {
+        for (size_t i = head; i < count; ++i) fn(values[i]);
+        for (size_t i = 0; i < head; ++i) fn(values[i]);
+    }
+
+    T sum() const {
+        T total = T{};
+        for_each([&](T value) { total += value; });
+        return total;
+    }
+};
@@ -1,34 +1,39 @@
 #include "sma_strategy.h"
 #include <algorithm>
-#include <numeric>
+#include <cmath>
 
 void SMACrossoverStrategy::on_bar(const MarketData& bar, Portfolio& portfolio) {
-    // Calculate short-term moving average
-    if (short_ma.size() >= static_cast<size_t>(short_window)) {
-        short_ma.erase(short_ma.begin());
-    }
-    short_ma.push_back(bar.close);
-    
-    // Calculate long-term moving average
-    if (long_ma.size() >= static_cast<size_t>(long_window)) {
-        long_ma.erase(long_ma.begin());
-    }
-    long_ma.push_back(bar.close);
+    double short_avg;
+    double long_avg;
     
-    // Only trade when we have enough data
-    if (short_ma.size() < static_cast<size_t>(short_window) || 
-        long_ma.size() < static_cast<size_t>(long_window)) {
-        return;
+    if (cached_short) {
+        // Columns are NaN until their window is full
+        size_t index = bar_index++;
+        if (index == 0) {
+            indicators::check_origin(*cached_short, bar);
+            indicators::check_origin(*cached_long, bar);
+        }
+        short_avg = cached_short->values.at(index);
+        long_avg = cached_long->values.at(index);
+        if (std::isnan(short_avg) || std::isnan(long_avg)) {
+            return;
+        }
+    } else {
+        // Slide both windows (fixed ring buffers, no allocation per bar)
+        short_ma.push(bar.close);
+        long_ma.push(bar.close);
+        
+        // Only trade when we have enough data
+        if (!short_ma.full() || !long_ma.full()) {
+            return;
+        }
+        
+        // Calculate averages
+        short_avg = short_ma.sum() / short_ma.size();
+        long_avg = long_ma.sum() / long_ma.size();
     }
     
-    // Calculate averages
-    double short_avg = std::accumulate(short_ma.begin(), short_ma.end(), 0.0) / short_ma.size();
-    double long_avg = std::accumulate(long_ma.begin(), long_ma.end(), 0.0) / long_ma.size();
-    
     // Trading logic: Buy when short MA crosses above long MA, sell when it crosses below
-    static double prev_short_avg = 0.0;
-    static double prev_long_avg = 0.0;
-    
     if (prev_short_avg > 0 && prev_long_avg > 0) {
         // Buy signal: short MA crosses above long MA
         if (prev_short_avg <= prev_long_avg && short_avg > long_avg) {
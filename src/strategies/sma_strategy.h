@@ -1,18 +1,37 @@
 #pragma once
 #include "../data_loader.h"
 #include "../backtester.h"
+#include "rolling_window.h"
+#include "../indicators/indicator_cache.h"
 
 // Simple moving average crossover strategy
 class SMACrossoverStrategy : public Strategy {
 private:
     int short_window;
     int long_window;
-    std::vector<double> short_ma;
-    std::vector<double> long_ma;
+    RollingWindow<double> short_ma;
+    RollingWindow<double> long_ma;
+    double prev_short_avg;
+    double prev_long_avg;
+    
+    // Precomputed SMA columns (e.g. from IndicatorCache), read by bar index instead of the windows
+    IndicatorColumn cached_short;
+    IndicatorColumn cached_long;
+    size_t bar_index;
     
 public:
     SMACrossoverStrategy(int short_w = 10, int long_w = 30) 
-        : short_window(short_w), long_window(long_w) {}
+        : short_window(short_w), long_window(long_w), 
+          short_ma(short_w), long_ma(long_w),
+          prev_short_avg(0.0), prev_long_avg(0.0), bar_index(0) {}
+    
+    // Bars must arrive in the order the columns were computed over, starting with the
+    // series' first bar; on_bar throws std::invalid_argument if the first bar is another date
+    SMACrossoverStrategy(int short_w, int long_w, IndicatorColumn short_column, IndicatorColumn long_column) 
+        : short_window(short_w), long_window(long_w), 
+          short_ma(0), long_ma(0),
+          prev_short_avg(0.0), prev_long_avg(0.0),
+          cached_short(std::move(short_column)), cached_long(std::move(long_column)), bar_index(0) {}
     
     ~SMACrossoverStrategy() override = default;
     
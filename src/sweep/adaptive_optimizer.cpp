@@ -0,0 +1,238 @@
+#include "adaptive_optimizer.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <map>
+#include <tuple>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Best first: survivors before pruned runs, then by total return, then grid order
+std::vector<size_t> rank(const std::vector<CandidateScore>& scores) {
+    std::vector<size_t> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (scores[a].pruned != scores[b].pruned) return !scores[a].pruned;
+        return scores[a].total_return > scores[b].total_return;
+    });
+    return order;
+}
+
+std::vector<CandidateScore> top_unpruned(const std::vector<CandidateScore>& scores, size_t k) {
+    std::vector<CandidateScore> top;
+    for (size_t index : rank(scores)) {
+        if (top.size() == k || scores[index].pruned) break;
+        top.push_back(scores[index]);
+    }
+    return top;
+}
+
+}
+
+AdaptiveOptimizer::AdaptiveOptimizer(const std::vector<MarketData>& market_data, const OptimizerConfig& config)
+    : market_data(market_data), config(config) {
+    this->config.top_k = std::max<size_t>(this->config.top_k, 1);
+    this->config.eta = std::max<size_t>(this->config.eta, 2);
+    this->config.population = std::max<size_t>(this->config.population, 2);
+    
+    // Every rung replays a prefix of the same history, so columns over the
+    // full closes serve all of them
+    if (config.indicator_cache_bytes > 0) {
+        series = PriceSeries::from_market_data(market_data);
+        cache = std::make_unique<IndicatorCache>(config.indicator_cache_bytes);
+    }
+}
+
+IndicatorCacheStats AdaptiveOptimizer::cache_stats() const {
+    return cache ? cache->get_stats() : IndicatorCacheStats{};
+}
+
+std::vector<CandidateScore> AdaptiveOptimizer::evaluate(const std::vector<SweepParams>& candidates, size_t bars, 
+                                                        bool early_stop, OptimizerReport& report) const {
+    bars = std::min(bars, market_data.size());
+    Backtester backtester(std::make_unique<VectorBarSource>(market_data, 0, bars), config.initial_cash, std::max<size_t>(bars, 1));
+    backtester.set_accounting(config.accounting);
+    
+    // Running peak of total value for the drawdown check, reset per candidate
+    double peak = config.initial_cash;
+    if (early_stop) {
+        const EarlyStopRule& rule = config.early_stop;
+        double initial_cash = config.initial_cash;
+        backtester.set_progress_hook([&peak, &rule, initial_cash](size_t bars_processed, const Portfolio& portfolio) {
+            peak = std::max(peak, portfolio.total_value);
+            if (bars_processed < rule.grace_bars) return true;
+            
+            double drawdown = (peak - portfolio.total_value) / peak * 100.0;
+            double running_return = (portfolio.total_value - initial_cash) / initial_cash * 100.0;
+            return drawdown <= rule.max_drawdown && running_return >= rule.min_return;
+        }, config.early_stop.check_interval);
+    }
+    
+    std::vector<CandidateScore> scores;
+    scores.reserve(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        peak = config.initial_cash;
+        SweepResult result = cache
+            ? run_sweep_job(backtester, static_cast<uint32_t>(i), candidates[i], *cache, series)
+            : run_sweep_job(backtester, static_cast<uint32_t>(i), candidates[i]);
+        
+        scores.push_back({candidates[i], result.total_return, result.max_drawdown, 
+                          result.bars_processed, result.cancelled != 0});
+        report.candidates_evaluated++;
+        report.bar_evaluations += result.bars_processed;
+        if (result.cancelled) report.candidates_pruned++;
+    }
+    
+    return scores;
+}
+
+OptimizerReport AdaptiveOptimizer::exhaustive(const std::vector<SweepParams>& grid) const {
+    OptimizerReport report;
+    auto scores = evaluate(grid, market_data.size(), false, report);
+    report.top = top_unpruned(scores, config.top_k);
+    return report;
+}
+
+OptimizerReport AdaptiveOptimizer::successive_halving(const std::vector<SweepParams>& grid) const {
+    OptimizerReport report;
+    if (grid.empty() || market_data.empty()) return report;
+    
+    const size_t full = market_data.size();
+    const size_t eta = config.eta;
+    
+    // As many rungs as the grid size and the minimum slice allow
+    size_t extra_rungs = 0;
+    size_t scale = eta;
+    while (grid.size() / scale >= config.top_k && full / scale >= config.min_slice) {
+        extra_rungs++;
+        scale *= eta;
+    }
+    
+    std::vector<SweepParams> survivors = grid;
+    std::vector<CandidateScore> scores;
+    
+    for (size_t rung = 0; rung <= extra_rungs; ++rung) {
+        size_t divisor = 1;
+        for (size_t i = rung; i < extra_rungs; ++i) divisor *= eta;
+        size_t slice = rung == extra_rungs ? full : full / divisor;
+        
+        scores = evaluate(survivors, slice, true, report);
+        if (rung == extra_rungs) break;
+        
+        // Promote the best 1/eta (never fewer than top_k) that were not pruned
+        size_t keep = std::max(config.top_k, (survivors.size() + eta - 1) / eta);
+        std::vector<SweepParams> next;
+        for (size_t index : rank(scores)) {
+            if (next.size() == keep || scores[index].pruned) break;
+            next.push_back(scores[index].params);
+        }
+        survivors = std::move(next);
+        if (survivors.empty()) break;
+    }
+    
+    report.top = top_unpruned(scores, config.top_k);
+    return report;
+}
+
+OptimizerReport AdaptiveOptimizer::evolutionary(const SearchSpace& space) const {
+    OptimizerReport report;
+    if (market_data.empty()) return report;
+    
+    std::mt19937 rng(config.seed);
+    bool crossover = space.kind != StrategyKind::MeanReversion;
+    
+    auto uniform_int = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, std::max(lo, hi))(rng); };
+    auto round_multiplier = [](double m) { return std::round(m * 100.0) / 100.0; };
+    
+    // Keep the crossover legs ordered and everything inside the space
+    auto repair = [&](SweepParams p) {
+        p.short_window = std::clamp(p.short_window, space.short_min, space.short_max);
+        if (crossover) {
+            p.long_window = std::clamp(p.long_window, std::max(space.long_min, p.short_window + 1), 
+                                       std::max(space.long_max, p.short_window + 1));
+            p.multiplier = 0.0;
+        } else {
+            p.long_window = 0;
+            p.multiplier = round_multiplier(std::clamp(p.multiplier, space.multiplier_min, space.multiplier_max));
+        }
+        return p;
+    };
+    
+    auto random_candidate = [&]() {
+        SweepParams p{space.kind, uniform_int(space.short_min, space.short_max), 0, 0.0};
+        p.long_window = uniform_int(std::max(space.long_min, p.short_window + 1), space.long_max);
+        p.multiplier = std::uniform_real_distribution<double>(space.multiplier_min, space.multiplier_max)(rng);
+        return repair(p);
+    };
+    
+    using Key = std::tuple<int, int, long>;
+    auto key_of = [](const SweepParams& p) { return Key{p.short_window, p.long_window, std::lround(p.multiplier * 100.0)}; };
+    std::map<Key, CandidateScore> seen;
+    
+    auto fitness = [&](const SweepParams& p) {
+        const CandidateScore& score = seen.at(key_of(p));
+        return score.pruned ? -std::numeric_limits<double>::infinity() : score.total_return;
+    };
+    
+    std::vector<SweepParams> population;
+    for (size_t i = 0; i < config.population; ++i) {
+        population.push_back(random_candidate());
+    }
+    
+    int short_step = std::max(1, (space.short_max - space.short_min) / 10);
+    int long_step = std::max(1, (space.long_max - space.long_min) / 10);
+    double multiplier_step = (space.multiplier_max - space.multiplier_min) / 10.0;
+    
+    for (size_t generation = 0; generation <= config.generations; ++generation) {
+        // Only run parameter sets we have not scored before
+        std::vector<SweepParams> fresh;
+        for (const auto& p : population) {
+            if (!seen.count(key_of(p)) && 
+                std::none_of(fresh.begin(), fresh.end(), [&](const SweepParams& f) { return key_of(f) == key_of(p); })) {
+                fresh.push_back(p);
+            }
+        }
+        for (const auto& score : evaluate(fresh, market_data.size(), true, report)) {
+            seen.emplace(key_of(score.params), score);
+        }
+        if (generation == config.generations) break;
+        
+        std::stable_sort(population.begin(), population.end(), 
+            [&](const SweepParams& a, const SweepParams& b) { return fitness(a) > fitness(b); });
+        
+        // Elitism: the better half survives, the rest are children of tournament winners
+        size_t elite = std::max<size_t>(config.population / 2, 1);
+        population.resize(elite);
+        auto tournament = [&]() {
+            const SweepParams& a = population[uniform_int(0, static_cast<int>(elite) - 1)];
+            const SweepParams& b = population[uniform_int(0, static_cast<int>(elite) - 1)];
+            return fitness(a) >= fitness(b) ? a : b;
+        };
+        
+        std::bernoulli_distribution mutate(config.mutation_rate);
+        while (population.size() < config.population) {
+            SweepParams mother = tournament();
+            SweepParams father = tournament();
+            
+            SweepParams child = mother;
+            child.long_window = father.long_window;
+            child.multiplier = (mother.multiplier + father.multiplier) / 2.0;
+            
+            if (mutate(rng)) child.short_window += uniform_int(-short_step, short_step);
+            if (mutate(rng)) child.long_window += uniform_int(-long_step, long_step);
+            if (mutate(rng)) child.multiplier += std::uniform_real_distribution<double>(-multiplier_step, multiplier_step)(rng);
+            
+            population.push_back(repair(child));
+        }
+    }
+    
+    std::vector<CandidateScore> all;
+    all.reserve(seen.size());
+    for (const auto& [key, score] : seen) {
+        all.push_back(score);
+    }
+    report.top = top_unpruned(all, config.top_k);
+    return report;
+}
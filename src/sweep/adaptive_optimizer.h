@@ -0,0 +1,83 @@
+#pragma once
+#include "sweep_job.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Abort a run once its running drawdown or return crosses a threshold
+struct EarlyStopRule {
+    double max_drawdown = 100.0;    // % peak-to-trough drop in total value
+    double min_return = -100.0;     // % return versus initial cash
+    size_t grace_bars = 50;         // Bars before the rule is applied
+    size_t check_interval = 1;      // Bars between checks
+};
+
+struct OptimizerConfig {
+    size_t top_k = 10;
+    double initial_cash = 100000.0;
+    Accounting accounting = Accounting::FloatingPoint;
+    size_t indicator_cache_bytes = 64 * 1024 * 1024;   // Shared across rungs and generations; 0 disables it
+    EarlyStopRule early_stop;
+    
+    // Successive halving: keep 1/eta of the candidates per rung, each rung on eta times more bars
+    size_t eta = 2;
+    size_t min_slice = 100;         // Smallest slice (in bars) any rung is evaluated on
+    
+    // Evolutionary search
+    size_t population = 32;
+    size_t generations = 12;
+    double mutation_rate = 0.3;
+    uint32_t seed = 42;
+};
+
+// Bounds for evolutionary search; windows are inclusive
+struct SearchSpace {
+    StrategyKind kind;
+    int short_min, short_max;       // Crossover short leg, or Bollinger lookback
+    int long_min, long_max;         // Crossover long leg (ignored for mean reversion)
+    double multiplier_min = 1.0;
+    double multiplier_max = 3.0;    // Bollinger multiplier (ignored for crossovers)
+};
+
+struct CandidateScore {
+    SweepParams params;
+    double total_return;
+    double max_drawdown;
+    size_t bars_evaluated;          // Bars of the last evaluation
+    bool pruned;                    // Stopped by the early-stop rule
+};
+
+struct OptimizerReport {
+    std::vector<CandidateScore> top;    // Best first, by full-history total return
+    size_t candidates_evaluated = 0;
+    size_t candidates_pruned = 0;
+    size_t bar_evaluations = 0;         // on_bar calls across all runs
+};
+
+// Finds the best parameter sets without running every candidate over the whole history
+class AdaptiveOptimizer {
+private:
+    const std::vector<MarketData>& market_data;
+    OptimizerConfig config;
+    PriceSeries series;
+    std::unique_ptr<IndicatorCache> cache;  // Null when disabled
+    
+    // Run each candidate on the first `bars` bars, optionally under the early-stop rule
+    std::vector<CandidateScore> evaluate(const std::vector<SweepParams>& candidates, size_t bars, 
+                                         bool early_stop, OptimizerReport& report) const;
+    
+public:
+    AdaptiveOptimizer(const std::vector<MarketData>& market_data, const OptimizerConfig& config);
+    
+    // Every candidate on the full history; the reference the adaptive modes are measured against
+    OptimizerReport exhaustive(const std::vector<SweepParams>& grid) const;
+    
+    // Evaluate on growing prefixes of the data, keeping the best 1/eta after each rung
+    OptimizerReport successive_halving(const std::vector<SweepParams>& grid) const;
+    
+    // Elitist genetic search over `space` on the full history with early stopping
+    OptimizerReport evolutionary(const SearchSpace& space) const;
+    
+    // Indicator cache counters so far (all zero when the cache is disabled)
+    IndicatorCacheStats cache_stats() const;
+};
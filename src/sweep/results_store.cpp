@@ -0,0 +1,415 @@
+#include "results_store.h"
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <fstream>
+#include <format>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+
+constexpr size_t MIN_ROWS_PER_THREAD = 1 << 16;
+constexpr uint32_t FORMAT_VERSION = 2;     // 2: no annualized return column
+
+struct StoreHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t column_count;
+    uint64_t row_count;
+};
+
+// Number of slices a scan over `rows` is split into (one thread each)
+size_t slice_count(size_t rows, size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<size_t>(rows / MIN_ROWS_PER_THREAD, 1, threads);
+}
+
+// Split [0, rows) into contiguous slices and run fn(slice, begin, end) on each
+template<typename F>
+void parallel_slices(size_t rows, size_t slices, F&& fn) {
+    if (slices == 1) {
+        fn(0, 0, rows);
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    workers.reserve(slices);
+    for (size_t slice = 0; slice < slices; ++slice) {
+        size_t begin = rows * slice / slices;
+        size_t end = rows * (slice + 1) / slices;
+        workers.emplace_back([&fn, slice, begin, end] { fn(slice, begin, end); });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// Narrow `rows` (or the whole [begin, end) slice when `first`) to those passing `filter`.
+// The comparison is resolved outside the loop so each scan is a tight pass over one column.
+template<typename Column, typename Op>
+void scan(const Column& column, Op op, size_t begin, size_t end, bool first, std::vector<uint32_t>& rows) {
+    if (first) {
+        for (size_t row = begin; row < end; ++row) {
+            if (op(static_cast<double>(column[row]))) rows.push_back(static_cast<uint32_t>(row));
+        }
+        return;
+    }
+    
+    size_t kept = 0;
+    for (uint32_t row : rows) {
+        if (op(static_cast<double>(column[row]))) rows[kept++] = row;
+    }
+    rows.resize(kept);
+}
+
+template<typename Column>
+void scan(const Column& column, const ResultFilter& filter, size_t begin, size_t end, bool first,
+          std::vector<uint32_t>& rows) {
+    double value = filter.value;
+    switch (filter.op) {
+        case Compare::Less: scan(column, [value](double x) { return x < value; }, begin, end, first, rows); break;
+        case Compare::LessEqual: scan(column, [value](double x) { return x <= value; }, begin, end, first, rows); break;
+        case Compare::Greater: scan(column, [value](double x) { return x > value; }, begin, end, first, rows); break;
+        case Compare::GreaterEqual: scan(column, [value](double x) { return x >= value; }, begin, end, first, rows); break;
+        case Compare::Equal: scan(column, [value](double x) { return x == value; }, begin, end, first, rows); break;
+        case Compare::NotEqual: scan(column, [value](double x) { return x != value; }, begin, end, first, rows); break;
+    }
+}
+
+// Ranking used by top_k: better value first, earlier row on ties
+struct Ranked {
+    double value;
+    uint32_t row;
+};
+
+struct RankBetter {
+    bool descending;
+    
+    bool operator()(const Ranked& a, const Ranked& b) const {
+        if (a.value != b.value) return descending ? a.value > b.value : a.value < b.value;
+        return a.row < b.row;
+    }
+};
+
+// Bounded heap of the best k candidates; the worst kept candidate sits on top.
+// Rows must be offered in ascending order, so once the heap is full a value
+// equal to the worst one can never win and one comparison rejects most rows.
+class TopK {
+private:
+    size_t k;
+    RankBetter better;
+    std::vector<Ranked> heap;
+    double worst;   // Value on top of the heap once it is full
+    
+public:
+    TopK(size_t k, RankBetter better) : k(k), better(better), worst(0.0) { heap.reserve(k); }
+    
+    void offer(double value, uint32_t row) {
+        if (heap.size() == k) {
+            // Also rejects NaN, which compares false either way
+            if (k == 0 || (better.descending ? !(value > worst) : !(value < worst))) return;
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = Ranked{value, row};
+        } else {
+            if (std::isnan(value)) return;
+            heap.push_back(Ranked{value, row});
+        }
+        std::push_heap(heap.begin(), heap.end(), better);
+        worst = heap.front().value;
+    }
+    
+    const std::vector<Ranked>& candidates() const { return heap; }
+};
+
+void check_stream(const std::ios& stream, const char* action, const std::string& path) {
+    if (!stream) {
+        throw std::runtime_error(std::format("Could not {} results store: {}", action, path));
+    }
+}
+
+}
+
+template<typename Store, typename F>
+void ResultsStore::visit_column(Store& store, ResultColumn column, F&& fn) {
+    switch (column) {
+        case ResultColumn::Kind: fn(store.kind); return;
+        case ResultColumn::ShortWindow: fn(store.short_window); return;
+        case ResultColumn::LongWindow: fn(store.long_window); return;
+        case ResultColumn::Multiplier: fn(store.multiplier); return;
+        case ResultColumn::TotalReturn: fn(store.total_return); return;
+        case ResultColumn::SharpeRatio: fn(store.sharpe_ratio); return;
+        case ResultColumn::MaxDrawdown: fn(store.max_drawdown); return;
+        case ResultColumn::WinRate: fn(store.win_rate); return;
+        case ResultColumn::AvgTradePnl: fn(store.avg_trade_pnl); return;
+        case ResultColumn::TotalTrades: fn(store.total_trades); return;
+        case ResultColumn::BarsProcessed: fn(store.bars_processed); return;
+        case ResultColumn::Cancelled: fn(store.cancelled); return;
+        case ResultColumn::ExecutionMicros: fn(store.execution_us); return;
+        case ResultColumn::Count: break;
+    }
+    throw std::out_of_range("Invalid result column");
+}
+
+void ResultsStore::push_params(const SweepParams& params) {
+    kind.push_back(static_cast<uint8_t>(params.kind));
+    short_window.push_back(params.short_window);
+    long_window.push_back(params.long_window);
+    multiplier.push_back(params.multiplier);
+}
+
+void ResultsStore::append(const SweepParams& params, const SweepResult& result) {
+    push_params(params);
+    total_return.push_back(result.total_return);
+    sharpe_ratio.push_back(result.sharpe_ratio);
+    max_drawdown.push_back(result.max_drawdown);
+    win_rate.push_back(result.win_rate);
+    avg_trade_pnl.push_back(result.avg_trade_pnl);
+    total_trades.push_back(result.total_trades);
+    bars_processed.push_back(result.bars_processed);
+    cancelled.push_back(result.cancelled != 0);
+    execution_us.push_back(result.execution_us);
+}
+
+void ResultsStore::append(const SweepParams& params, const BacktestResult& result) {
+    push_params(params);
+    total_return.push_back(result.total_return);
+    sharpe_ratio.push_back(result.sharpe_ratio);
+    max_drawdown.push_back(result.max_drawdown);
+    win_rate.push_back(result.win_rate);
+    avg_trade_pnl.push_back(result.avg_trade_pnl);
+    total_trades.push_back(static_cast<uint32_t>(result.all_trades.size()));
+    bars_processed.push_back(static_cast<uint32_t>(result.bars_processed));
+    cancelled.push_back(result.cancelled);
+    execution_us.push_back(result.execution_time.count());
+}
+
+void ResultsStore::append(const std::vector<SweepParams>& grid, const std::vector<SweepResult>& results) {
+    if (grid.size() != results.size()) {
+        throw std::invalid_argument(std::format("Grid has {} points but {} results", grid.size(), results.size()));
+    }
+    
+    reserve(size() + grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        append(grid[i], results[i]);
+    }
+}
+
+void ResultsStore::reserve(size_t rows) {
+    for (uint32_t c = 0; c < static_cast<uint32_t>(ResultColumn::Count); ++c) {
+        visit_column(*this, static_cast<ResultColumn>(c), [rows](auto& values) { values.reserve(rows); });
+    }
+}
+
+void ResultsStore::clear() {
+    for (uint32_t c = 0; c < static_cast<uint32_t>(ResultColumn::Count); ++c) {
+        visit_column(*this, static_cast<ResultColumn>(c), [](auto& values) { values.clear(); });
+    }
+}
+
+double ResultsStore::value(ResultColumn column, size_t row) const {
+    double result = 0.0;
+    visit_column(*this, column, [&](const auto& values) { result = static_cast<double>(values.at(row)); });
+    return result;
+}
+
+SweepParams ResultsStore::params(size_t row) const {
+    return SweepParams{static_cast<StrategyKind>(kind.at(row)), short_window.at(row),
+                       long_window.at(row), multiplier.at(row)};
+}
+
+std::vector<uint32_t> ResultsStore::select(const std::vector<ResultFilter>& filters) const {
+    size_t slices = slice_count(size(), threads);
+    std::vector<std::vector<uint32_t>> partial(slices);
+    
+    parallel_slices(size(), slices, [&](size_t slice, size_t begin, size_t end) {
+        auto& rows = partial[slice];
+        if (filters.empty()) {
+            rows.resize(end - begin);
+            for (size_t row = begin; row < end; ++row) rows[row - begin] = static_cast<uint32_t>(row);
+            return;
+        }
+        
+        for (size_t i = 0; i < filters.size(); ++i) {
+            visit_column(*this, filters[i].column, [&](const auto& values) {
+                scan(values, filters[i], begin, end, i == 0, rows);
+            });
+            if (rows.empty()) break;
+        }
+    });
+    
+    // Slices are contiguous and in order, so concatenating keeps rows ascending
+    size_t total = 0;
+    for (const auto& part : partial) total += part.size();
+    
+    std::vector<uint32_t> rows;
+    rows.reserve(total);
+    for (const auto& part : partial) rows.insert(rows.end(), part.begin(), part.end());
+    return rows;
+}
+
+std::vector<uint32_t> ResultsStore::top_k(ResultColumn column, size_t k, SortOrder order,
+                                          const std::vector<ResultFilter>& filters) const {
+    RankBetter better{order == SortOrder::Descending};
+    std::vector<uint32_t> rows;
+    bool all_rows = filters.empty();
+    if (!all_rows) rows = select(filters);
+    
+    size_t count = all_rows ? size() : rows.size();
+    size_t slices = slice_count(count, threads);
+    std::vector<TopK> partial(slices, TopK(k, better));
+    
+    if (all_rows) {
+        visit_column(*this, column, [&](const auto& values) {
+            parallel_slices(count, slices, [&](size_t slice, size_t begin, size_t end) {
+                for (size_t row = begin; row < end; ++row) {
+                    partial[slice].offer(static_cast<double>(values[row]), static_cast<uint32_t>(row));
+                }
+            });
+        });
+    } else {
+        visit_column(*this, column, [&](const auto& values) {
+            parallel_slices(count, slices, [&](size_t slice, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    partial[slice].offer(static_cast<double>(values[rows[i]]), rows[i]);
+                }
+            });
+        });
+    }
+    
+    std::vector<Ranked> merged;
+    for (const auto& heap : partial) {
+        merged.insert(merged.end(), heap.candidates().begin(), heap.candidates().end());
+    }
+    size_t keep = std::min(k, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + keep, merged.end(), better);
+    
+    std::vector<uint32_t> best(keep);
+    for (size_t i = 0; i < keep; ++i) best[i] = merged[i].row;
+    return best;
+}
+
+std::vector<GroupSummary> ResultsStore::aggregate(ResultColumn key, ResultColumn value,
+                                                  const std::vector<ResultFilter>& filters) const {
+    using Groups = std::unordered_map<double, GroupSummary>;
+    auto accumulate = [](Groups& groups, double k, double v) {
+        if (std::isnan(v)) return;
+        auto [it, inserted] = groups.try_emplace(k, GroupSummary{k, 0, 0.0, v, v});
+        GroupSummary& group = it->second;
+        group.count++;
+        group.sum += v;
+        group.min = std::min(group.min, v);
+        group.max = std::max(group.max, v);
+    };
+    
+    std::vector<uint32_t> rows;
+    bool all_rows = filters.empty();
+    if (!all_rows) rows = select(filters);
+    
+    size_t count = all_rows ? size() : rows.size();
+    size_t slices = slice_count(count, threads);
+    std::vector<Groups> partial(slices);
+    
+    visit_column(*this, key, [&](const auto& keys) {
+        visit_column(*this, value, [&](const auto& values) {
+            parallel_slices(count, slices, [&](size_t slice, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    size_t row = all_rows ? i : rows[i];
+                    accumulate(partial[slice], static_cast<double>(keys[row]), static_cast<double>(values[row]));
+                }
+            });
+        });
+    });
+    
+    Groups merged;
+    for (const auto& groups : partial) {
+        for (const auto& [k, group] : groups) {
+            auto [it, inserted] = merged.try_emplace(k, group);
+            if (inserted) continue;
+            it->second.count += group.count;
+            it->second.sum += group.sum;
+            it->second.min = std::min(it->second.min, group.min);
+            it->second.max = std::max(it->second.max, group.max);
+        }
+    }
+    
+    std::vector<GroupSummary> summaries;
+    summaries.reserve(merged.size());
+    for (const auto& [k, group] : merged) summaries.push_back(group);
+    std::sort(summaries.begin(), summaries.end(),
+        [](const GroupSummary& a, const GroupSummary& b) { return a.key < b.key; });
+    return summaries;
+}
+
+void ResultsStore::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    check_stream(file, "create", path);
+    
+    StoreHeader header{MAGIC, FORMAT_VERSION, static_cast<uint32_t>(ResultColumn::Count), size()};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    // Columns are written back to back in ResultColumn order
+    for (uint32_t c = 0; c < header.column_count; ++c) {
+        visit_column(*this, static_cast<ResultColumn>(c), [&](const auto& values) {
+            file.write(reinterpret_cast<const char*>(values.data()),
+                       static_cast<std::streamsize>(values.size() * sizeof(values[0])));
+        });
+    }
+    check_stream(file, "write", path);
+}
+
+ResultsStore ResultsStore::load(const std::string& path, size_t threads) {
+    std::ifstream file(path, std::ios::binary);
+    check_stream(file, "open", path);
+    
+    StoreHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != MAGIC || header.version != FORMAT_VERSION ||
+        header.column_count != static_cast<uint32_t>(ResultColumn::Count)) {
+        throw std::runtime_error(std::format("Invalid results store file: {}", path));
+    }
+    
+    // The columns must fill the rest of the file exactly, which also rules out a
+    // corrupt row count before anything is allocated for it
+    ResultsStore store(threads);
+    size_t row_bytes = 0;
+    for (uint32_t c = 0; c < header.column_count; ++c) {
+        visit_column(store, static_cast<ResultColumn>(c), [&](const auto& values) { row_bytes += sizeof(values[0]); });
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t column_bytes = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+    file.seekg(sizeof(header));
+    check_stream(file, "read", path);
+    if (column_bytes % row_bytes != 0 || header.row_count != column_bytes / row_bytes) {
+        throw std::runtime_error(std::format("Results store {} does not hold {} rows of {} bytes",
+            path, header.row_count, row_bytes));
+    }
+    
+    for (uint32_t c = 0; c < header.column_count; ++c) {
+        visit_column(store, static_cast<ResultColumn>(c), [&](auto& values) {
+            values.resize(header.row_count);
+            file.read(reinterpret_cast<char*>(values.data()),
+                      static_cast<std::streamsize>(values.size() * sizeof(values[0])));
+        });
+        check_stream(file, "read", path);
+    }
+    return store;
+}
+
+const char* ResultsStore::column_name(ResultColumn column) {
+    switch (column) {
+        case ResultColumn::Kind: return "Kind";
+        case ResultColumn::ShortWindow: return "Short Window";
+        case ResultColumn::LongWindow: return "Long Window";
+        case ResultColumn::Multiplier: return "Multiplier";
+        case ResultColumn::TotalReturn: return "Total Return";
+        case ResultColumn::SharpeRatio: return "Sharpe Ratio";
+        case ResultColumn::MaxDrawdown: return "Max Drawdown";
+        case ResultColumn::WinRate: return "Win Rate";
+        case ResultColumn::AvgTradePnl: return "Avg Trade PnL";
+        case ResultColumn::TotalTrades: return "Total Trades";
+        case ResultColumn::BarsProcessed: return "Bars Processed";
+        case ResultColumn::Cancelled: return "Cancelled";
+        case ResultColumn::ExecutionMicros: return "Execution Time (us)";
+        case ResultColumn::Count: break;
+    }
+    return "Unknown";
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "sweep_job.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Columns of the results store: the sweep parameters, then the metrics
+enum class ResultColumn : uint32_t {
+    Kind,
+    ShortWindow,
+    LongWindow,
+    Multiplier,
+    TotalReturn,
+    SharpeRatio,
+    MaxDrawdown,
+    WinRate,
+    AvgTradePnl,
+    TotalTrades,
+    BarsProcessed,
+    Cancelled,
+    ExecutionMicros,
+    Count
+};
+
+enum class Compare : uint32_t {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+// One condition of a query; a query matches rows that satisfy all of them
+struct ResultFilter {
+    ResultColumn column;
+    Compare op;
+    double value;
+};
+
+enum class SortOrder {
+    Ascending,
+    Descending
+};
+
+struct GroupSummary {
+    double key;
+    size_t count;
+    double sum;
+    double min;
+    double max;
+    
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+};
+
+// In-process columnar store of sweep results. Each column is a contiguous
+// array, so filters, top-K and grouped aggregation are plain scans, split
+// across threads for large stores. Row i is the i-th appended result.
+class ResultsStore {
+private:
+    std::vector<uint8_t> kind;
+    std::vector<int32_t> short_window;
+    std::vector<int32_t> long_window;
+    std::vector<double> multiplier;
+    std::vector<double> total_return;
+    std::vector<double> sharpe_ratio;
+    std::vector<double> max_drawdown;
+    std::vector<double> win_rate;
+    std::vector<double> avg_trade_pnl;
+    std::vector<uint32_t> total_trades;
+    std::vector<uint32_t> bars_processed;
+    std::vector<uint8_t> cancelled;
+    std::vector<int64_t> execution_us;
+    
+    size_t threads;     // Scan parallelism; 0 means one per hardware thread
+    
+    // Call fn with the column's vector (const or not, following `store`)
+    template<typename Store, typename F>
+    static void visit_column(Store& store, ResultColumn column, F&& fn);
+    
+    void push_params(const SweepParams& params);
+
+public:
+    static constexpr uint64_t MAGIC = 0x5452414445525331ULL;  // "TRADERS1"
+    
+    explicit ResultsStore(size_t threads = 0) : threads(threads) {}
+    
+    void append(const SweepParams& params, const SweepResult& result);
+    void append(const SweepParams& params, const BacktestResult& result);
+    
+    // Bulk append of a sweep; results[i] belongs to grid[i]
+    void append(const std::vector<SweepParams>& grid, const std::vector<SweepResult>& results);
+    
+    void reserve(size_t rows);
+    void clear();
+    size_t size() const { return kind.size(); }
+    
+    // Row access
+    double value(ResultColumn column, size_t row) const;
+    SweepParams params(size_t row) const;
+    
+    // Rows (in ascending order) matching every filter
+    std::vector<uint32_t> select(const std::vector<ResultFilter>& filters) const;
+    
+    // Best `k` rows by `column`, best first; ties go to the earlier row and NaNs never rank
+    std::vector<uint32_t> top_k(ResultColumn column, size_t k, SortOrder order = SortOrder::Descending,
+                                const std::vector<ResultFilter>& filters = {}) const;
+    
+    // count/sum/min/max of `value` for each distinct `key`, ordered by key
+    std::vector<GroupSummary> aggregate(ResultColumn key, ResultColumn value,
+                                        const std::vector<ResultFilter>& filters = {}) const;
+    
+    // Single-file binary persistence; throws std::runtime_error on I/O or format
+    // errors, including a file whose size does not match its row count
+    void save(const std::string& path) const;
+    static ResultsStore load(const std::string& path, size_t threads = 0);
+    
+    static const char* column_name(ResultColumn column);
+};
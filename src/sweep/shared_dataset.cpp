@@ -0,0 +1,142 @@
+#include "shared_dataset.h"
+#include <format>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+std::runtime_error os_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(std::format("{} {}: {}", what, path, std::strerror(errno)));
+}
+
+}
+
+SharedDataset SharedDataset::create(const std::string& path, const std::vector<MarketData>& data) {
+    size_t size = sizeof(SharedDatasetHeader) + data.size() * sizeof(PackedBar);
+    
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) throw os_error("Could not create dataset", path);
+    
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        ::unlink(path.c_str());
+        throw os_error("Could not size dataset", path);
+    }
+    
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::unlink(path.c_str());
+        throw os_error("Could not map dataset", path);
+    }
+    
+    auto* header = static_cast<SharedDatasetHeader*>(mapping);
+    auto* bars = reinterpret_cast<PackedBar*>(header + 1);
+    for (size_t i = 0; i < data.size(); ++i) {
+        const auto& src = data[i];
+        if (src.date.size() >= sizeof(PackedBar::date)) {
+            ::munmap(mapping, size);
+            ::unlink(path.c_str());
+            throw std::runtime_error(std::format("Date too long for shared dataset: {}", src.date));
+        }
+        
+        PackedBar& dst = bars[i];
+        std::memset(dst.date, 0, sizeof(dst.date));
+        std::memcpy(dst.date, src.date.data(), src.date.size());
+        dst.open = src.open;
+        dst.high = src.high;
+        dst.low = src.low;
+        dst.close = src.close;
+        dst.volume = src.volume;
+    }
+    header->bar_count = data.size();
+    header->magic = MAGIC;
+    
+    // Workers only ever read
+    ::mprotect(mapping, size, PROT_READ);
+    
+    return SharedDataset(path, mapping, size, true);
+}
+
+SharedDataset SharedDataset::attach(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw os_error("Could not open dataset", path);
+    
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw os_error("Could not stat dataset", path);
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size < sizeof(SharedDatasetHeader)) {
+        ::close(fd);
+        throw std::runtime_error(std::format("Dataset too small: {}", path));
+    }
+    
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) throw os_error("Could not map dataset", path);
+    
+    const auto* header = static_cast<const SharedDatasetHeader*>(mapping);
+    if (header->magic != MAGIC ||
+        size < sizeof(SharedDatasetHeader) + header->bar_count * sizeof(PackedBar)) {
+        ::munmap(mapping, size);
+        throw std::runtime_error(std::format("Invalid dataset file: {}", path));
+    }
+    
+    return SharedDataset(path, mapping, size, false);
+}
+
+SharedDataset::SharedDataset(SharedDataset&& other) noexcept
+    : path(std::move(other.path)), mapping(other.mapping), mapping_size(other.mapping_size), owner(other.owner) {
+    other.mapping = nullptr;
+    other.owner = false;
+}
+
+SharedDataset::~SharedDataset() {
+    if (mapping) {
+        ::munmap(mapping, mapping_size);
+    }
+    if (owner) {
+        ::unlink(path.c_str());
+    }
+}
+
+size_t SharedDataset::size() const {
+    return static_cast<const SharedDatasetHeader*>(mapping)->bar_count;
+}
+
+const PackedBar* SharedDataset::bars() const {
+    return reinterpret_cast<const PackedBar*>(static_cast<const SharedDatasetHeader*>(mapping) + 1);
+}
+
+MarketData SharedDataset::unpack(const PackedBar& bar) {
+    MarketData row;
+    row.date = bar.date;
+    row.open = bar.open;
+    row.high = bar.high;
+    row.low = bar.low;
+    row.close = bar.close;
+    row.volume = static_cast<long>(bar.volume);
+    return row;
+}
+
+// SharedBarSource implementation
+bool SharedBarSource::next_chunk(std::vector<MarketData>& out, size_t max_bars) {
+    out.clear();
+    
+    size_t count = std::min(max_bars, dataset.size() - cursor);
+    const PackedBar* bars = dataset.bars() + cursor;
+    for (size_t i = 0; i < count; ++i) {
+        out.push_back(SharedDataset::unpack(bars[i]));
+    }
+    cursor += count;
+    
+    return !out.empty();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "../data_loader.h"
+#include "../bar_source.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Fixed-layout bar so the dataset can be mapped directly by other processes
+struct PackedBar {
+    char date[16];  // NUL-terminated
+    double open;
+    double high;
+    double low;
+    double close;
+    int64_t volume;
+};
+
+struct SharedDatasetHeader {
+    uint64_t magic;
+    uint64_t bar_count;
+};
+
+// Read-only memory-mapped market data shared between sweep processes.
+// The owner writes the file once; workers attach without re-parsing the CSV.
+class SharedDataset {
+private:
+    std::string path;
+    void* mapping;
+    size_t mapping_size;
+    bool owner;
+    
+    SharedDataset(const std::string& path, void* mapping, size_t mapping_size, bool owner)
+        : path(path), mapping(mapping), mapping_size(mapping_size), owner(owner) {}
+    
+public:
+    static constexpr uint64_t MAGIC = 0x5452414445534d31ULL;  // "TRADESM1"
+    
+    // Write `data` to `path` (e.g. under /dev/shm) and map it; the file is removed on destruction
+    static SharedDataset create(const std::string& path, const std::vector<MarketData>& data);
+    
+    // Map an existing dataset read-only
+    static SharedDataset attach(const std::string& path);
+    
+    SharedDataset(SharedDataset&& other) noexcept;
+    SharedDataset& operator=(SharedDataset&&) = delete;
+    SharedDataset(const SharedDataset&) = delete;
+    SharedDataset& operator=(const SharedDataset&) = delete;
+    ~SharedDataset();
+    
+    const std::string& get_path() const { return path; }
+    size_t size() const;
+    const PackedBar* bars() const;
+    
+    static MarketData unpack(const PackedBar& bar);
+};
+
+// Bar source over a mapped dataset; chunks are unpacked on demand. Only a
+// reference is kept, so the dataset must outlive the source; temporaries are rejected.
+class SharedBarSource : public BarSource {
+private:
+    const SharedDataset& dataset;
+    size_t cursor;
+    
+public:
+    explicit SharedBarSource(const SharedDataset& dataset) : dataset(dataset), cursor(0) {}
+    SharedBarSource(SharedDataset&&) = delete;
+    
+    bool next_chunk(std::vector<MarketData>& out, size_t max_bars) override;
+    void reset() override { cursor = 0; }
+    bool is_resident() const override { return true; }
+};
@@ -0,0 +1,416 @@
+#include "sweep_coordinator.h"
+#include <format>
+#include <stdexcept>
+#include <algorithm>
+#include <set>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+namespace {
+
+bool send_message(int fd, const SweepMessage& msg) {
+    const char* data = reinterpret_cast<const char*>(&msg);
+    size_t sent = 0;
+    while (sent < sizeof(msg)) {
+        ssize_t n = ::send(fd, data + sent, sizeof(msg) - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Blocking read of one whole message; false on EOF or error
+bool read_message(int fd, SweepMessage& msg) {
+    char* data = reinterpret_cast<char*>(&msg);
+    size_t received = 0;
+    while (received < sizeof(msg)) {
+        ssize_t n = ::recv(fd, data + received, sizeof(msg) - received, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        received += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+sockaddr_un make_address(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(std::format("Socket path too long: {}", path));
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+}
+
+// ForkLauncher implementation
+long ForkLauncher::launch(const WorkerSpec& spec) {
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        throw std::runtime_error(std::format("fork failed: {}", std::strerror(errno)));
+    }
+    
+    if (pid == 0) {
+        // Drop the coordinator's sockets so only the coordinator holds them. One
+        // close_range call; the per-fd loop is only for kernels without it (< 5.9).
+        if (::close_range(3, ~0U, 0) != 0) {
+            long max_fd = std::min(::sysconf(_SC_OPEN_MAX), 65536L);
+            for (long fd = 3; fd < (max_fd > 0 ? max_fd : 1024); ++fd) {
+                ::close(static_cast<int>(fd));
+            }
+        }
+        
+        int code = 1;
+        try {
+            code = run_sweep_worker(spec);
+        } catch (...) {
+            code = 1;
+        }
+        ::_exit(code);
+    }
+    
+    return pid;
+}
+
+bool ForkLauncher::has_exited(long handle) {
+    if (reaped.count(handle)) return true;
+    
+    int status = 0;
+    pid_t result = ::waitpid(static_cast<pid_t>(handle), &status, WNOHANG);
+    if (result == static_cast<pid_t>(handle) || (result < 0 && errno == ECHILD)) {
+        reaped.insert(handle);
+        return true;
+    }
+    return false;
+}
+
+void ForkLauncher::reap(long handle) {
+    if (reaped.erase(handle)) return;
+    
+    ::kill(static_cast<pid_t>(handle), SIGKILL);
+    int status = 0;
+    while (::waitpid(static_cast<pid_t>(handle), &status, 0) < 0 && errno == EINTR) {}
+}
+
+// FaultInjectingLauncher implementation
+long FaultInjectingLauncher::launch(const WorkerSpec& spec) {
+    WorkerSpec faulty = spec;
+    if (launched < crashes) {
+        faulty.fault = WorkerFault::Crash;
+    } else if (launched < crashes + hangs) {
+        faulty.fault = WorkerFault::Hang;
+    }
+    faulty.fault_after_jobs = after_jobs;
+    launched++;
+    return inner.launch(faulty);
+}
+
+// Worker implementation
+int run_sweep_worker(const WorkerSpec& spec) {
+    auto dataset = SharedDataset::attach(spec.dataset_path);
+    
+    // The mapping is already resident, so one chunk covers the whole history
+    Backtester backtester(std::make_unique<SharedBarSource>(dataset), spec.initial_cash, dataset.size());
+    backtester.set_accounting(spec.accounting);
+    
+    // Jobs share indicator columns: a grid reuses each window across many pairs
+    std::vector<double> closes;
+    closes.reserve(dataset.size());
+    for (size_t i = 0; i < dataset.size(); ++i) {
+        closes.push_back(dataset.bars()[i].close);
+    }
+    std::string origin = dataset.size() > 0 ? std::string(dataset.bars()[0].date) : std::string();
+    PriceSeries series = PriceSeries::from_closes(std::move(closes), std::move(origin));
+    IndicatorCache cache(spec.indicator_cache_bytes);
+    
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return 1;
+    
+    sockaddr_un addr = make_address(spec.socket_path);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return 1;
+    }
+    
+    SweepMessage msg{};
+    msg.type = SweepMessageType::Hello;
+    msg.worker_id = spec.worker_id;
+    if (!send_message(fd, msg)) {
+        ::close(fd);
+        return 1;
+    }
+    
+    size_t jobs_run = 0;
+    while (read_message(fd, msg)) {
+        if (msg.type == SweepMessageType::Shutdown) break;
+        if (msg.type != SweepMessageType::RunJob) continue;
+        
+        if (spec.fault != WorkerFault::None && jobs_run == spec.fault_after_jobs) {
+            if (spec.fault == WorkerFault::Crash) ::_exit(3);
+            for (;;) ::pause();     // Hang until the coordinator kills us
+        }
+        jobs_run++;
+        
+        SweepMessage reply{};
+        reply.type = SweepMessageType::Result;
+        reply.worker_id = spec.worker_id;
+        reply.job_id = msg.job_id;
+        reply.result = spec.indicator_cache_bytes > 0
+            ? run_sweep_job(backtester, msg.job_id, msg.params, cache, series)
+            : run_sweep_job(backtester, msg.job_id, msg.params);
+        if (!send_message(fd, reply)) break;
+    }
+    
+    ::close(fd);
+    return 0;
+}
+
+// SweepCoordinator implementation
+SweepCoordinator::SweepCoordinator(const std::vector<MarketData>& market_data, const SweepConfig& config, WorkerLauncher& launcher)
+    : market_data(market_data), config(config), launcher(launcher), 
+      next_worker_id(0), restarts(0), failures(0), timeouts(0) {
+    this->config.num_workers = std::max<size_t>(this->config.num_workers, 1);
+    this->config.shard_size = std::max<size_t>(this->config.shard_size, 1);
+}
+
+std::chrono::steady_clock::time_point SweepCoordinator::deadline_from_now() const {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(config.job_timeout_ms);
+}
+
+void SweepCoordinator::spawn_worker(const WorkerSpec& base) {
+    WorkerSpec spec = base;
+    spec.worker_id = next_worker_id++;
+    
+    WorkerState state;
+    state.worker_id = spec.worker_id;
+    state.handle = launcher.launch(spec);
+    state.fd = -1;
+    state.deadline = deadline_from_now();
+    workers.push_back(std::move(state));
+}
+
+void SweepCoordinator::top_up(WorkerState& worker, const std::vector<SweepParams>& grid) {
+    while (worker.in_flight.size() < config.shard_size && !pending.empty()) {
+        uint32_t job_id = pending.front();
+        
+        SweepMessage msg{};
+        msg.type = SweepMessageType::RunJob;
+        msg.worker_id = worker.worker_id;
+        msg.job_id = job_id;
+        msg.params = grid[job_id];
+        if (!send_message(worker.fd, msg)) return;  // Failure surfaces as EOF on the next poll
+        
+        pending.pop_front();
+        if (worker.in_flight.empty()) worker.deadline = deadline_from_now();
+        worker.in_flight.push_back(job_id);
+    }
+}
+
+void SweepCoordinator::retire(size_t index, bool failed) {
+    WorkerState& worker = workers[index];
+    
+    if (worker.fd >= 0) {
+        ::close(worker.fd);
+    }
+    launcher.reap(worker.handle);
+    
+    // Anything the worker had not reported goes back to the front of the queue
+    for (auto it = worker.in_flight.rbegin(); it != worker.in_flight.rend(); ++it) {
+        pending.push_front(*it);
+    }
+    
+    workers.erase(workers.begin() + static_cast<long>(index));
+    if (failed) {
+        failures++;
+    }
+}
+
+std::vector<SweepResult> SweepCoordinator::run(const std::vector<SweepParams>& grid) {
+    std::vector<SweepResult> results(grid.size());
+    if (grid.empty()) return results;
+    
+    std::vector<bool> done(grid.size(), false);
+    size_t completed = 0;
+    
+    pending.clear();
+    for (uint32_t i = 0; i < grid.size(); ++i) {
+        pending.push_back(i);
+    }
+    
+    std::string prefix = std::format("{}/trade_sim_sweep_{}", config.work_dir, ::getpid());
+    auto dataset = SharedDataset::create(prefix + ".dat", market_data);
+    
+    std::string socket_path = prefix + ".sock";
+    sockaddr_un addr = make_address(socket_path);
+    ::unlink(socket_path.c_str());
+    
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 ||
+        ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd, static_cast<int>(config.num_workers)) != 0) {
+        std::string error = std::strerror(errno);
+        if (listen_fd >= 0) ::close(listen_fd);
+        throw std::runtime_error(std::format("Could not listen on {}: {}", socket_path, error));
+    }
+    
+    WorkerSpec base{0, socket_path, dataset.get_path(), config.initial_cash, config.accounting,
+                    config.indicator_cache_bytes, WorkerFault::None, 0};
+    
+    auto shutdown = [&]() {
+        for (auto& worker : workers) {
+            if (worker.fd >= 0) {
+                SweepMessage msg{};
+                msg.type = SweepMessageType::Shutdown;
+                send_message(worker.fd, msg);
+                ::close(worker.fd);
+                worker.fd = -1;
+            }
+        }
+        for (auto& worker : workers) {
+            // Give workers a moment to exit on their own before reap() forces it
+            for (int i = 0; i < 500 && !launcher.has_exited(worker.handle); ++i) {
+                ::usleep(1000);
+            }
+            launcher.reap(worker.handle);
+        }
+        workers.clear();
+        ::close(listen_fd);
+        ::unlink(socket_path.c_str());
+    };
+    
+    try {
+        for (size_t i = 0; i < config.num_workers; ++i) {
+            spawn_worker(base);
+        }
+        
+        while (completed < grid.size()) {
+            if (workers.empty()) {
+                throw std::runtime_error(std::format(
+                    "All sweep workers failed ({} of {} jobs completed)", completed, grid.size()));
+            }
+            
+            std::vector<pollfd> fds;
+            fds.push_back({listen_fd, POLLIN, 0});
+            for (const auto& worker : workers) {
+                fds.push_back({worker.fd, static_cast<short>(worker.fd >= 0 ? POLLIN : 0), 0});
+            }
+            
+            if (::poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+                throw std::runtime_error(std::format("poll failed: {}", std::strerror(errno)));
+            }
+            
+            std::vector<size_t> dead;
+            
+            // Collect messages first; fds[i + 1] lines up with workers[i]
+            for (size_t i = 0; i < workers.size(); ++i) {
+                WorkerState& worker = workers[i];
+                short revents = fds[i + 1].revents;
+                
+                if (worker.fd < 0) {
+                    if (launcher.has_exited(worker.handle)) dead.push_back(i);
+                    continue;
+                }
+                if (!(revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                
+                char buffer[4096];
+                ssize_t n = ::recv(worker.fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    if (n < 0 && errno == EINTR) continue;
+                    dead.push_back(i);
+                    continue;
+                }
+                worker.recv_buffer.insert(worker.recv_buffer.end(), buffer, buffer + n);
+                
+                size_t offset = 0;
+                while (worker.recv_buffer.size() - offset >= sizeof(SweepMessage)) {
+                    SweepMessage msg;
+                    std::memcpy(&msg, worker.recv_buffer.data() + offset, sizeof(msg));
+                    offset += sizeof(msg);
+                    
+                    if (msg.type != SweepMessageType::Result || msg.job_id >= grid.size()) continue;
+                    
+                    auto it = std::find(worker.in_flight.begin(), worker.in_flight.end(), msg.job_id);
+                    if (it != worker.in_flight.end()) worker.in_flight.erase(it);
+                    worker.deadline = deadline_from_now();
+                    
+                    if (!done[msg.job_id]) {
+                        done[msg.job_id] = true;
+                        results[msg.job_id] = msg.result;
+                        completed++;
+                    }
+                }
+                worker.recv_buffer.erase(worker.recv_buffer.begin(), worker.recv_buffer.begin() + static_cast<long>(offset));
+                
+                top_up(worker, grid);
+            }
+            
+            // New connections identify themselves with a Hello
+            if (fds[0].revents & POLLIN) {
+                int fd = ::accept(listen_fd, nullptr, nullptr);
+                SweepMessage hello;
+                if (fd >= 0) {
+                    timeval timeout{1, 0};
+                    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                    
+                    auto it = workers.end();
+                    if (read_message(fd, hello) && hello.type == SweepMessageType::Hello) {
+                        it = std::find_if(workers.begin(), workers.end(), 
+                            [&](const WorkerState& w) { return w.worker_id == hello.worker_id && w.fd < 0; });
+                    }
+                    
+                    if (it == workers.end()) {
+                        ::close(fd);
+                    } else {
+                        timeval no_timeout{0, 0};
+                        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &no_timeout, sizeof(no_timeout));
+                        it->fd = fd;
+                        it->deadline = deadline_from_now();
+                        top_up(*it, grid);
+                    }
+                }
+            }
+            
+            // A worker that has not connected, or holds jobs but has gone quiet, past its
+            // deadline is presumed hung; retiring it kills it and requeues its jobs
+            if (config.job_timeout_ms > 0) {
+                auto now = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < workers.size(); ++i) {
+                    const WorkerState& worker = workers[i];
+                    bool waiting = worker.fd < 0 || !worker.in_flight.empty();
+                    if (waiting && now > worker.deadline && std::find(dead.begin(), dead.end(), i) == dead.end()) {
+                        dead.push_back(i);
+                        timeouts++;
+                    }
+                }
+            }
+            
+            // Retire from the back so earlier indices stay valid
+            std::sort(dead.rbegin(), dead.rend());
+            for (size_t index : dead) {
+                retire(index, true);
+                if (!pending.empty() && restarts < config.max_restarts) {
+                    restarts++;
+                    spawn_worker(base);
+                }
+            }
+            
+            // Requeued jobs go to whichever connected worker has room
+            for (auto& worker : workers) {
+                if (worker.fd >= 0) top_up(worker, grid);
+            }
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+    
+    shutdown();
+    return results;
+}
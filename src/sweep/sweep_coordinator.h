@@ -0,0 +1,146 @@
+#pragma once
+#include "sweep_job.h"
+#include "shared_dataset.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <chrono>
+#include <cstdint>
+
+// Failures a worker can be told to simulate, to exercise recovery
+enum class WorkerFault : uint32_t {
+    None,
+    Crash,      // Exit abruptly, losing the job in hand
+    Hang        // Stop responding without exiting
+};
+
+// Everything a worker process needs to join a sweep
+struct WorkerSpec {
+    uint32_t worker_id;
+    std::string socket_path;    // Coordinator's Unix socket
+    std::string dataset_path;   // Shared read-only market data
+    double initial_cash;
+    Accounting accounting;
+    size_t indicator_cache_bytes;   // 0 recomputes indicators in every job
+    WorkerFault fault;
+    size_t fault_after_jobs;        // Jobs completed before the fault triggers
+};
+
+// Starts worker processes. Local runs fork; other launchers (ssh, a cluster
+// scheduler) only need to get `run_sweep_worker(spec)` executed somewhere.
+class WorkerLauncher {
+public:
+    virtual ~WorkerLauncher() = default;
+    
+    // Start a worker and return an opaque handle for it
+    virtual long launch(const WorkerSpec& spec) = 0;
+    
+    // Non-blocking check used to notice workers that die before connecting
+    virtual bool has_exited(long handle) = 0;
+    
+    // Make sure the worker is gone and release its resources
+    virtual void reap(long handle) = 0;
+};
+
+// Forks the current process; the child runs the worker loop and exits
+class ForkLauncher : public WorkerLauncher {
+private:
+    std::set<long> reaped;  // Collected by has_exited, so reap() must not touch the pid again
+    
+public:
+    long launch(const WorkerSpec& spec) override;
+    bool has_exited(long handle) override;
+    void reap(long handle) override;
+};
+
+// Wraps another launcher and makes the first workers it starts fail after
+// `after_jobs` jobs: `crashes` of them crash, then `hangs` of them hang.
+// Later launches (the replacements) run normally. Lets recovery be checked
+// on one machine against a clean run of the same grid.
+class FaultInjectingLauncher : public WorkerLauncher {
+private:
+    WorkerLauncher& inner;
+    size_t crashes;
+    size_t hangs;
+    size_t after_jobs;
+    size_t launched;
+    
+public:
+    FaultInjectingLauncher(WorkerLauncher& inner, size_t crashes, size_t hangs, size_t after_jobs)
+        : inner(inner), crashes(crashes), hangs(hangs), after_jobs(after_jobs), launched(0) {}
+    
+    long launch(const WorkerSpec& spec) override;
+    bool has_exited(long handle) override { return inner.has_exited(handle); }
+    void reap(long handle) override { inner.reap(handle); }
+};
+
+struct SweepConfig {
+    size_t num_workers = 4;
+    size_t shard_size = 16;       // Jobs kept in flight per worker
+    size_t max_restarts = 4;      // Replacement workers allowed after failures
+    double initial_cash = 100000.0;
+    Accounting accounting = Accounting::FloatingPoint;  // FixedPoint for bit-reproducible metrics
+    size_t indicator_cache_bytes = 64 * 1024 * 1024;    // Per-worker indicator cache; 0 disables it
+    size_t job_timeout_ms = 60000;  // A worker holding jobs that reports nothing for this long is presumed hung
+    std::string work_dir = "/tmp"; // Where the socket and dataset file live (/dev/shm for RAM-backed)
+};
+
+// Wire protocol between coordinator and workers (fixed-size messages)
+enum class SweepMessageType : uint32_t {
+    Hello,
+    RunJob,
+    Shutdown,
+    Result
+};
+
+struct SweepMessage {
+    SweepMessageType type;
+    uint32_t worker_id;
+    uint32_t job_id;
+    SweepParams params;
+    SweepResult result;
+};
+
+// Worker entry point: attach to the dataset, connect, run jobs until shutdown
+int run_sweep_worker(const WorkerSpec& spec);
+
+// Shards a parameter grid across worker processes and collects their results.
+// Jobs held by a worker that dies, or that reports nothing within the job
+// timeout, are requeued and a replacement is launched.
+class SweepCoordinator {
+private:
+    struct WorkerState {
+        uint32_t worker_id;
+        long handle;
+        int fd;                        // -1 until the worker connects
+        std::vector<uint32_t> in_flight;
+        std::vector<char> recv_buffer;
+        std::chrono::steady_clock::time_point deadline;    // For connecting, then for the next result
+    };
+    
+    const std::vector<MarketData>& market_data;
+    SweepConfig config;
+    WorkerLauncher& launcher;
+    
+    std::vector<WorkerState> workers;
+    std::deque<uint32_t> pending;
+    uint32_t next_worker_id;
+    size_t restarts;
+    size_t failures;
+    size_t timeouts;
+    
+    std::chrono::steady_clock::time_point deadline_from_now() const;
+    void spawn_worker(const WorkerSpec& base);
+    void top_up(WorkerState& worker, const std::vector<SweepParams>& grid);
+    void retire(size_t index, bool failed);
+    
+public:
+    SweepCoordinator(const std::vector<MarketData>& market_data, const SweepConfig& config, WorkerLauncher& launcher);
+    
+    // Run every grid point; result i corresponds to grid[i]
+    std::vector<SweepResult> run(const std::vector<SweepParams>& grid);
+    
+    size_t get_failure_count() const { return failures; }
+    size_t get_timeout_count() const { return timeouts; }   // Failures that were hung workers
+};
@@ -0,0 +1,117 @@
+#include "sweep_job.h"
+#include "../strategies/sma_strategy.h"
+#include "../strategies/ema_strategy.h"
+#include "../strategies/mean_reversion_strategy.h"
+#include <format>
+
+std::vector<SweepParams> ParameterGrid::crossover(StrategyKind kind, 
+                                                  const std::vector<int>& short_windows, 
+                                                  const std::vector<int>& long_windows) {
+    std::vector<SweepParams> grid;
+    grid.reserve(short_windows.size() * long_windows.size());
+    
+    for (int short_w : short_windows) {
+        for (int long_w : long_windows) {
+            if (short_w >= long_w) continue;  // Crossover needs a faster short leg
+            grid.push_back({kind, short_w, long_w, 0.0});
+        }
+    }
+    
+    return grid;
+}
+
+std::vector<SweepParams> ParameterGrid::mean_reversion(const std::vector<int>& lookbacks, 
+                                                       const std::vector<double>& multipliers) {
+    std::vector<SweepParams> grid;
+    grid.reserve(lookbacks.size() * multipliers.size());
+    
+    for (int lookback : lookbacks) {
+        for (double multiplier : multipliers) {
+            grid.push_back({StrategyKind::MeanReversion, lookback, 0, multiplier});
+        }
+    }
+    
+    return grid;
+}
+
+std::vector<int> ParameterGrid::range(int first, int last, int step) {
+    std::vector<int> values;
+    for (int v = first; v <= last; v += step) {
+        values.push_back(v);
+    }
+    return values;
+}
+
+std::string describe(const SweepParams& params) {
+    switch (params.kind) {
+        case StrategyKind::SMACrossover:
+            return std::format("SMA({}, {})", params.short_window, params.long_window);
+        case StrategyKind::EMACrossover:
+            return std::format("EMA({}, {})", params.short_window, params.long_window);
+        case StrategyKind::MeanReversion:
+            return std::format("MeanRev({}, {:.2f})", params.short_window, params.multiplier);
+    }
+    return "Unknown";
+}
+
+namespace {
+
+SweepResult to_sweep_result(uint32_t job_id, const BacktestResult& result) {
+    SweepResult out;
+    out.job_id = job_id;
+    out.total_trades = static_cast<uint32_t>(result.all_trades.size());
+    out.total_return = result.total_return;
+    out.sharpe_ratio = result.sharpe_ratio;
+    out.max_drawdown = result.max_drawdown;
+    out.win_rate = result.win_rate;
+    out.avg_trade_pnl = result.avg_trade_pnl;
+    out.bars_processed = static_cast<uint32_t>(result.bars_processed);
+    out.cancelled = result.cancelled ? 1 : 0;
+    out.execution_us = result.execution_time.count();
+    return out;
+}
+
+}
+
+SweepResult run_sweep_job(Backtester& backtester, uint32_t job_id, const SweepParams& params) {
+    switch (params.kind) {
+        case StrategyKind::SMACrossover: {
+            SMACrossoverStrategy strategy(params.short_window, params.long_window);
+            return to_sweep_result(job_id, backtester.run_backtest(strategy));
+        }
+        case StrategyKind::EMACrossover: {
+            EMACrossoverStrategy strategy(params.short_window, params.long_window);
+            return to_sweep_result(job_id, backtester.run_backtest(strategy));
+        }
+        case StrategyKind::MeanReversion: {
+            MeanReversionStrategy strategy(params.short_window, params.multiplier);
+            return to_sweep_result(job_id, backtester.run_backtest(strategy));
+        }
+    }
+    throw std::invalid_argument("Unknown strategy kind");
+}
+
+SweepResult run_sweep_job(Backtester& backtester, uint32_t job_id, const SweepParams& params,
+                          IndicatorCache& cache, const PriceSeries& series) {
+    switch (params.kind) {
+        case StrategyKind::SMACrossover: {
+            SMACrossoverStrategy strategy(params.short_window, params.long_window,
+                                          cache.get(IndicatorKind::SMA, params.short_window, series),
+                                          cache.get(IndicatorKind::SMA, params.long_window, series));
+            return to_sweep_result(job_id, backtester.run_backtest(strategy));
+        }
+        case StrategyKind::EMACrossover: {
+            EMACrossoverStrategy strategy(params.short_window, params.long_window,
+                                          cache.get(IndicatorKind::EMA, params.short_window, series),
+                                          cache.get(IndicatorKind::EMA, params.long_window, series));
+            return to_sweep_result(job_id, backtester.run_backtest(strategy));
+        }
+        case StrategyKind::MeanReversion: {
+            MeanReversionStrategy strategy(params.short_window, params.multiplier,
+                                           cache.get(IndicatorKind::SMA, params.short_window, series),
+                                           cache.get(IndicatorKind::StdDev, params.short_window, series));
+            return to_sweep_result(job_id, backtester.run_backtest(strategy));
+        }
+    }
+    throw std::invalid_argument("Unknown strategy kind");
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "../backtester.h"
+#include "../indicators/indicator_cache.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+enum class StrategyKind : uint32_t {
+    SMACrossover,
+    EMACrossover,
+    MeanReversion
+};
+
+// One point of a parameter grid. Trivially copyable so it can go over a socket as-is.
+struct SweepParams {
+    StrategyKind kind;
+    int32_t short_window;   // SMA/EMA short leg, or Bollinger lookback
+    int32_t long_window;    // SMA/EMA long leg (unused for mean reversion)
+    double multiplier;      // Bollinger std multiplier (unused for crossovers)
+};
+
+// Compact per-job metrics streamed back from workers
+struct SweepResult {
+    uint32_t job_id;
+    uint32_t total_trades;
+    double total_return;
+    double sharpe_ratio;
+    double max_drawdown;
+    double win_rate;
+    double avg_trade_pnl;
+    uint32_t bars_processed;
+    uint32_t cancelled;     // Non-zero when stopped early by a progress hook
+    int64_t execution_us;   // Backtest wall time
+};
+
+class ParameterGrid {
+public:
+    static std::vector<SweepParams> crossover(StrategyKind kind, 
+                                              const std::vector<int>& short_windows, 
+                                              const std::vector<int>& long_windows);
+    static std::vector<SweepParams> mean_reversion(const std::vector<int>& lookbacks, 
+                                                   const std::vector<double>& multipliers);
+    
+    // Inclusive integer range helper for building grids
+    static std::vector<int> range(int first, int last, int step = 1);
+};
+
+std::string describe(const SweepParams& params);
+
+// Build the strategy described by `params` and run it on `backtester`
+SweepResult run_sweep_job(Backtester& backtester, uint32_t job_id, const SweepParams& params);
+
+// Same, with the strategy's indicators taken from `cache` instead of being
+// recomputed per job. `series` must hold the closes of the bars `backtester`
+// replays, in order and starting from its first bar.
+SweepResult run_sweep_job(Backtester& backtester, uint32_t job_id, const SweepParams& params,
+                          IndicatorCache& cache, const PriceSeries& series);